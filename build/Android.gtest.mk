@@ -26,6 +26,7 @@ GTEST_DEX_DIRECTORIES := \
   AllFields \
   ExceptionHandle \
   GetMethodSignature \
+  InstrumentedMethods \
   Interfaces \
   Main \
   MyClass \
@@ -50,6 +51,7 @@ ART_GTEST_class_linker_test_DEX_DEPS := Interfaces MyClass Nested Statics Static
 ART_GTEST_compiler_driver_test_DEX_DEPS := AbstractMethod
 ART_GTEST_dex_file_test_DEX_DEPS := GetMethodSignature
 ART_GTEST_exception_test_DEX_DEPS := ExceptionHandle
+ART_GTEST_instrumentation_test_DEX_DEPS := InstrumentedMethods
 ART_GTEST_jni_compiler_test_DEX_DEPS := MyClassNatives
 ART_GTEST_jni_internal_test_DEX_DEPS := AllFields StaticLeafMethods
 ART_GTEST_object_test_DEX_DEPS := ProtoCompare ProtoCompare2 StaticsFromCode XandY
@@ -67,6 +69,7 @@ LOCAL_PATH := art
 
 RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/arch/arch_test.cc \
+  runtime/arch/memchr16_test.cc \
   runtime/arch/memcmp16_test.cc \
   runtime/arch/stub_test.cc \
   runtime/barrier_test.cc \
@@ -110,13 +113,16 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/instruction_set_test.cc \
   runtime/intern_table_test.cc \
   runtime/leb128_test.cc \
+  runtime/mapping_table_index_test.cc \
   runtime/mem_map_test.cc \
   runtime/mirror/dex_cache_test.cc \
   runtime/mirror/object_test.cc \
   runtime/monitor_pool_test.cc \
   runtime/monitor_test.cc \
   runtime/parsed_options_test.cc \
+  runtime/perf_map_test.cc \
   runtime/reference_table_test.cc \
+  runtime/thread_list_test.cc \
   runtime/thread_pool_test.cc \
   runtime/transaction_test.cc \
   runtime/utils_test.cc \
@@ -125,6 +131,7 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/zip_archive_test.cc
 
 COMPILER_GTEST_COMMON_SRC_FILES := \
+  runtime/instrumentation_test.cc \
   runtime/jni_internal_test.cc \
   runtime/proxy_test.cc \
   runtime/reflection_test.cc \
@@ -1486,10 +1486,6 @@ bool Mir2Lir::GenInlinedIndexOf(CallInfo* info, bool zero_based) {
     // TODO - add Mips implementation
     return false;
   }
-  if (cu_->instruction_set == kX86_64) {
-    // TODO - add kX86_64 implementation
-    return false;
-  }
   RegLocation rl_obj = info->args[0];
   RegLocation rl_char = info->args[1];
   if (rl_char.is_const && (mir_graph_->ConstantValue(rl_char) & ~0xFFFF) != 0) {
@@ -1511,12 +1507,17 @@ bool Mir2Lir::GenInlinedIndexOf(CallInfo* info, bool zero_based) {
     RegLocation rl_start = info->args[2];     // 3rd arg only present in III flavor of IndexOf.
     LoadValueDirectFixed(rl_start, reg_start);
   }
-  RegStorage r_tgt = LoadHelper(kQuickIndexOf);
+  RegStorage r_tgt;
+  if (cu_->instruction_set != kX86_64) {
+    r_tgt = LoadHelper(kQuickIndexOf);
+  } else {
+    r_tgt = RegStorage::InvalidReg();
+  }
   GenExplicitNullCheck(reg_ptr, info->opt_flags);
   LIR* high_code_point_branch =
       rl_char.is_const ? nullptr : OpCmpImmBranch(kCondGt, reg_char, 0xFFFF, nullptr);
   // NOTE: not a safepoint
-  OpReg(kOpBlx, r_tgt);
+  CallHelper(r_tgt, kQuickIndexOf, false, true);
   if (!rl_char.is_const) {
     // Add the slow path for code points beyond 0xFFFF.
     DCHECK(high_code_point_branch != nullptr);
@@ -1238,6 +1238,11 @@ bool X86Mir2Lir::GenInlinedArrayCopyCharArray(CallInfo* info) {
  * otherwise bails to standard library code.
  */
 bool X86Mir2Lir::GenInlinedIndexOf(CallInfo* info, bool zero_based) {
+  if (cu_->target64) {
+    // REPNE SCASW is microcoded; x86-64 has a vectorized art_quick_indexof instead.
+    return Mir2Lir::GenInlinedIndexOf(info, zero_based);
+  }
+
   RegLocation rl_obj = info->args[0];
   RegLocation rl_char = info->args[1];
   RegLocation rl_start;  // Note: only present in III flavor or IndexOf.
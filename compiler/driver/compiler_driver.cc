@@ -2106,6 +2106,10 @@ void CompilerDriver::CompileMethod(const DexFile::CodeItem* code_item, uint32_t
         (instruction_set_ == kX86_64 || instruction_set_ == kArm64)) {
       // Leaving this empty will trigger the generic JNI version
     } else {
+      if (dex_file.IsCriticalNativeMethod(dex_file.GetClassDef(class_def_idx), method_idx,
+                                          access_flags)) {
+        access_flags |= kAccCriticalNative;
+      }
       compiled_method = compiler_->JniCompile(access_flags, method_idx, dex_file);
       CHECK(compiled_method != nullptr);
     }
@@ -2298,6 +2302,19 @@ bool CompilerDriver::SkipCompilation(const std::string& method_name) {
   return !compile;
 }
 
+bool CompilerDriver::IsHotMethod(const std::string& method_name) const {
+  if (!profile_present_) {
+    return false;
+  }
+  ProfileFile::ProfileData data;
+  if (!profile_file_.GetProfileData(&data, method_name)) {
+    return false;
+  }
+  // Same bucket test as SkipCompilation.
+  return data.GetTopKUsedPercentage() - data.GetUsedPercent()
+         <= compiler_options_->GetTopKProfileThreshold();
+}
+
 std::string CompilerDriver::GetMemoryUsageString(bool extended) const {
   std::ostringstream oss;
   const ArenaPool* arena_pool = GetArenaPool();
@@ -664,6 +664,9 @@ class CompilerDriver {
   // Should the compiler run on this method given profile information?
   bool SkipCompilation(const std::string& method_name);
 
+  // Is the method part of the top K% of the profile samples? False if there is no profile.
+  bool IsHotMethod(const std::string& method_name) const;
+
   // Get memory usage during compilation.
   std::string GetMemoryUsageString(bool extended) const;
 
@@ -16,6 +16,8 @@
 
 #include "image.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,6 +28,8 @@
 #include "gc/space/image_space.h"
 #include "image_writer.h"
 #include "lock_word.h"
+#include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
 #include "mirror/object-inl.h"
 #include "oat_writer.h"
 #include "scoped_thread_state_change.h"
@@ -35,6 +39,16 @@
 
 namespace art {
 
+// Grows [*begin, *end) to cover obj, if there is one.
+static void ExtendRange(mirror::Object* obj, uintptr_t* begin, uintptr_t* end)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  if (obj != nullptr) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(obj);
+    *begin = std::min(*begin, address);
+    *end = std::max(*end, address + obj->SizeOf());
+  }
+}
+
 class ImageTest : public CommonCompilerTest {
  protected:
   virtual void SetUp() {
@@ -171,6 +185,9 @@ TEST_F(ImageTest, WriteRead) {
   byte* image_begin = image_space->Begin();
   byte* image_end = image_space->End();
   CHECK_EQ(requested_image_base, reinterpret_cast<uintptr_t>(image_begin));
+  std::vector<uintptr_t> image_class_addresses;
+  uintptr_t method_tables_begin = std::numeric_limits<uintptr_t>::max();
+  uintptr_t method_tables_end = 0;
   for (size_t i = 0; i < dex->NumClassDefs(); ++i) {
     const DexFile::ClassDef& class_def = dex->GetClassDef(i);
     const char* descriptor = dex->GetClassDescriptor(class_def);
@@ -180,6 +197,17 @@ TEST_F(ImageTest, WriteRead) {
       // Image classes should be located inside the image.
       EXPECT_LT(image_begin, reinterpret_cast<byte*>(klass)) << descriptor;
       EXPECT_LT(reinterpret_cast<byte*>(klass), image_end) << descriptor;
+      image_class_addresses.push_back(reinterpret_cast<uintptr_t>(klass));
+      ExtendRange(klass->GetVTable(), &method_tables_begin, &method_tables_end);
+      mirror::IfTable* iftable = klass->GetIfTable();
+      if (iftable != nullptr) {
+        ExtendRange(iftable, &method_tables_begin, &method_tables_end);
+        for (size_t j = 0, count = iftable->Count(); j < count; ++j) {
+          if (iftable->GetMethodArrayCount(j) != 0) {
+            ExtendRange(iftable->GetMethodArray(j), &method_tables_begin, &method_tables_end);
+          }
+        }
+      }
     } else {
       EXPECT_TRUE(reinterpret_cast<byte*>(klass) >= image_end ||
                   reinterpret_cast<byte*>(klass) < image_begin) << descriptor;
@@ -187,6 +215,27 @@ TEST_F(ImageTest, WriteRead) {
     EXPECT_TRUE(Monitor::IsValidLockWord(klass->GetLockWord(false)));
   }
 
+  // The method tables of the image classes and the resolved arrays of the boot dex caches are
+  // packed into two adjacent bins, which come before the class bins.
+  uintptr_t dex_cache_arrays_begin = std::numeric_limits<uintptr_t>::max();
+  uintptr_t dex_cache_arrays_end = 0;
+  for (const DexFile* dex_file : class_linker_->GetBootClassPath()) {
+    mirror::DexCache* dex_cache = class_linker_->FindDexCache(*dex_file);
+    ExtendRange(dex_cache->GetStrings(), &dex_cache_arrays_begin, &dex_cache_arrays_end);
+    ExtendRange(dex_cache->GetResolvedTypes(), &dex_cache_arrays_begin, &dex_cache_arrays_end);
+    ExtendRange(dex_cache->GetResolvedMethods(), &dex_cache_arrays_begin, &dex_cache_arrays_end);
+    ExtendRange(dex_cache->GetResolvedFields(), &dex_cache_arrays_begin, &dex_cache_arrays_end);
+  }
+  ASSERT_LT(method_tables_begin, method_tables_end);
+  ASSERT_LT(dex_cache_arrays_begin, dex_cache_arrays_end);
+  EXPECT_LE(reinterpret_cast<uintptr_t>(image_begin), method_tables_begin);
+  EXPECT_LE(method_tables_end, dex_cache_arrays_begin);
+  EXPECT_LE(dex_cache_arrays_end, reinterpret_cast<uintptr_t>(image_end));
+  for (uintptr_t klass : image_class_addresses) {
+    EXPECT_TRUE(klass < method_tables_begin || klass >= dex_cache_arrays_end)
+        << reinterpret_cast<void*>(klass);
+  }
+
   image_file.Unlink();
   oat_file.Unlink();
   int rmdir_result = rmdir(image_dir.c_str());
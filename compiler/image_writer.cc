@@ -47,6 +47,7 @@
 #include "mirror/class-inl.h"
 #include "mirror/class_loader.h"
 #include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/string-inl.h"
@@ -279,13 +280,6 @@ void ImageWriter::SetImageBinSlot(mirror::Object* object, BinSlot bin_slot) {
 
 void ImageWriter::AssignImageBinSlot(mirror::Object* object) {
   DCHECK(object != nullptr);
-  size_t object_size;
-  if (object->IsArtMethod()) {
-    // Methods are sized based on the target pointer size.
-    object_size = mirror::ArtMethod::InstanceSize(target_ptr_size_);
-  } else {
-    object_size = object->SizeOf();
-  }
 
   // The magic happens here. We segregate objects into different bins based
   // on how likely they are to get dirty at runtime.
@@ -316,6 +310,13 @@ void ImageWriter::AssignImageBinSlot(mirror::Object* object) {
     //            [their interpreter/quick entry points are trampolines until the class
     //             becomes initialized]
     //
+    // Independently of dirtiness, some objects are read on nearly every invoke:
+    //  * vtables and iftables [virtual and interface dispatch]
+    //  * dex cache resolved arrays [static/direct dispatch, field and type resolution]
+    //  * art methods that the profile says are hot
+    // These go into adjacent bins so that startup touches fewer pages and TLB entries. The
+    // method tables are assigned by AssignHotArrayBinSlots before the regular walk.
+    //
     // We also assume the following objects get dirtied either never or extremely rarely:
     //  * Strings (they are immutable)
     //  * Art methods that aren't native and have initialized declared classes
@@ -359,6 +360,11 @@ void ImageWriter::AssignImageBinSlot(mirror::Object* object) {
         mirror::Class* declaring_class = art_method->GetDeclaringClass();
         if (declaring_class->GetStatus() != Class::kStatusInitialized) {
           bin = kBinArtMethodNotInitialized;
+        } else if (compiler_driver_.ProfilePresent() &&
+                   compiler_driver_.IsHotMethod(PrettyMethod(art_method))) {
+          // Clean like the below, but called during startup. Keep these on as few pages as
+          // possible instead of scattering them among the cold methods.
+          bin = kBinArtMethodsManagedInitializedHot;
         } else {
           // This is highly unlikely to dirty since there's no entry points to mutate.
           bin = kBinArtMethodsManagedInitialized;
@@ -369,6 +375,19 @@ void ImageWriter::AssignImageBinSlot(mirror::Object* object) {
     }  // else bin = kBinRegular
   }
 
+  AssignImageBinSlot(object, bin);
+}
+
+void ImageWriter::AssignImageBinSlot(mirror::Object* object, Bin bin) {
+  DCHECK(object != nullptr);
+  size_t object_size;
+  if (object->IsArtMethod()) {
+    // Methods are sized based on the target pointer size.
+    object_size = mirror::ArtMethod::InstanceSize(target_ptr_size_);
+  } else {
+    object_size = object->SizeOf();
+  }
+
   size_t current_offset = bin_slot_sizes_[bin];  // How many bytes the current bin is at (aligned).
   // Move the current bin size up to accomodate the object we just assigned a bin slot.
   size_t offset_delta = RoundUp(object_size, kObjectAlignment);  // 64-bit alignment
@@ -872,6 +891,42 @@ void ImageWriter::WalkFieldsCallback(mirror::Object* obj, void* arg) {
   writer->WalkFieldsInOrder(obj);
 }
 
+void ImageWriter::AssignHotArrayBinSlot(mirror::Object* array, Bin bin) {
+  if (array != nullptr && !IsImageBinSlotAssigned(array)) {
+    AssignImageBinSlot(array, bin);
+  }
+}
+
+void ImageWriter::AssignHotArrayBinSlots(mirror::Object* obj) {
+  if (obj->IsClass()) {
+    mirror::Class* klass = obj->AsClass();
+    // Instantiable classes embed their vtable, everybody else keeps it in an array.
+    AssignHotArrayBinSlot(klass->GetVTable(), kBinMethodTable);
+    mirror::IfTable* iftable = klass->GetIfTable();
+    if (iftable != nullptr) {
+      AssignHotArrayBinSlot(iftable, kBinMethodTable);
+      for (size_t i = 0, count = iftable->Count(); i < count; ++i) {
+        if (iftable->GetMethodArrayCount(i) != 0) {
+          AssignHotArrayBinSlot(iftable->GetMethodArray(i), kBinMethodTable);
+        }
+      }
+    }
+  } else if (obj->GetClass() ==
+             Runtime::Current()->GetClassLinker()->GetClassRoot(ClassLinker::kJavaLangDexCache)) {
+    mirror::DexCache* dex_cache = down_cast<mirror::DexCache*>(obj);
+    AssignHotArrayBinSlot(dex_cache->GetStrings(), kBinDexCacheArray);
+    AssignHotArrayBinSlot(dex_cache->GetResolvedTypes(), kBinDexCacheArray);
+    AssignHotArrayBinSlot(dex_cache->GetResolvedMethods(), kBinDexCacheArray);
+    AssignHotArrayBinSlot(dex_cache->GetResolvedFields(), kBinDexCacheArray);
+  }
+}
+
+void ImageWriter::AssignHotArrayBinSlotsCallback(mirror::Object* obj, void* arg) {
+  ImageWriter* writer = reinterpret_cast<ImageWriter*>(arg);
+  DCHECK(writer != nullptr);
+  writer->AssignHotArrayBinSlots(obj);
+}
+
 void ImageWriter::UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg) {
   ImageWriter* writer = reinterpret_cast<ImageWriter*>(arg);
   DCHECK(writer != nullptr);
@@ -909,6 +964,10 @@ void ImageWriter::CalculateNewObjectOffsets(size_t oat_loaded_size, size_t oat_d
     const char* old = self->StartAssertNoThreadSuspension("ImageWriter");
     DCHECK_LT(image_end_, image_->Size());
     image_objects_offset_begin_ = image_end_;
+    if (kBinObjects) {
+      // Pull the method tables out of the walk order, see AssignImageBinSlot.
+      heap->VisitObjects(AssignHotArrayBinSlotsCallback, this);
+    }
     // Clear any pre-existing monitors which may have been in the monitor words, assign bin slots.
     heap->VisitObjects(WalkFieldsCallback, this);
     // Transform each object's bin slot into an offset which will be used to do the final copy.
@@ -1263,8 +1322,8 @@ size_t ImageWriter::GetBinSizeSum(ImageWriter::Bin up_to) const {
 
 ImageWriter::BinSlot::BinSlot(uint32_t lockword) : lockword_(lockword) {
   // These values may need to get updated if more bins are added to the enum Bin
-  static_assert(kBinBits == 3, "wrong number of bin bits");
-  static_assert(kBinShift == 29, "wrong number of shift");
+  static_assert(kBinBits == 4, "wrong number of bin bits");
+  static_assert(kBinShift == 28, "wrong number of shift");
   static_assert(sizeof(BinSlot) == sizeof(LockWord), "BinSlot/LockWord must have equal sizes");
 
   DCHECK_LT(GetBin(), kBinSize);
@@ -75,6 +75,10 @@ class ImageWriter FINAL {
     kBinArtMethodsManagedInitialized,  // [ArtMethod] Not-native, and initialized. Unlikely to dirty
     // Unknown mix of clean/dirty:
     kBinRegular,
+    // Hot, read on most invokes. Packed next to each other so that startup touches few pages:
+    kBinArtMethodsManagedInitializedHot,  // [ArtMethod] As above, but in the profile's top K
+    kBinMethodTable,              // [ArtMethod[]] Vtables and iftable method arrays. Read-only
+    kBinDexCacheArray,            // [Object[]] Dex cache resolved arrays. Filled in at runtime
     // Likely-dirty:
     // All classes get their own bins since their fields often dirty
     kBinClassInitializedFinalStatics,  // Class initializers have been run, no non-final statics
@@ -125,6 +129,8 @@ class ImageWriter FINAL {
   size_t GetImageOffset(mirror::Object* object) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   void AssignImageBinSlot(mirror::Object* object) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void AssignImageBinSlot(mirror::Object* object, Bin bin)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void SetImageBinSlot(mirror::Object* object, BinSlot bin_slot)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   bool IsImageBinSlotAssigned(mirror::Object* object) const
@@ -210,6 +216,14 @@ class ImageWriter FINAL {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static void WalkFieldsCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Put the method tables of classes and the resolved arrays of dex caches into the hot bins
+  // before the regular walk reaches them through some other referrer.
+  void AssignHotArrayBinSlots(mirror::Object* obj)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void AssignHotArrayBinSlot(mirror::Object* array, Bin bin)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void AssignHotArrayBinSlotsCallback(mirror::Object* obj, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static void UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
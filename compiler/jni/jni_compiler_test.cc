@@ -150,6 +150,8 @@ class JniCompilerTest : public CommonCompilerTest {
   void RunStaticReturnTrueImpl();
   void RunStaticReturnFalseImpl();
   void RunGenericStaticReturnIntImpl();
+  void CompileAndRunCriticalNativeLongMethodImpl();
+  void CompileAndRunCriticalNativeDoubleMethodImpl();
   void CompileAndRunStaticIntObjectObjectMethodImpl();
   void CompileAndRunStaticSynchronizedIntObjectObjectMethodImpl();
   void ExceptionHandlingImpl();
@@ -611,6 +613,55 @@ void JniCompilerTest::RunGenericStaticReturnIntImpl() {
 
 JNI_TEST(RunGenericStaticReturnInt)
 
+// Critical natives are passed no JNIEnv* or jclass. Compiled stubs call them while Runnable, the
+// generic JNI trampoline still transitions to Native.
+ThreadState gJava_MyClassNatives_critical_state = kTerminated;
+
+jlong Java_MyClassNatives_criticalIJIJ(jint i1, jlong l1, jint i2, jlong l2) {
+  gJava_MyClassNatives_critical_state = Thread::Current()->GetState();
+  EXPECT_EQ(1, i1);
+  EXPECT_EQ(INT64_C(0x200000003), l1);
+  EXPECT_EQ(4, i2);
+  EXPECT_EQ(INT64_C(-0x500000006), l2);
+  return l1 + l2;
+}
+
+void JniCompilerTest::CompileAndRunCriticalNativeLongMethodImpl() {
+  TEST_DISABLED_FOR_PORTABLE();
+  SetUpForTest(true, "criticalIJIJ", "(IJIJ)J",
+               reinterpret_cast<void*>(&Java_MyClassNatives_criticalIJIJ));
+
+  gJava_MyClassNatives_critical_state = kTerminated;
+  jlong result = env_->CallStaticLongMethod(jklass_, jmethod_, 1, INT64_C(0x200000003), 4,
+                                            INT64_C(-0x500000006));
+  EXPECT_EQ(INT64_C(-0x300000003), result);
+  EXPECT_EQ(check_generic_jni_ ? kNative : kRunnable, gJava_MyClassNatives_critical_state);
+}
+
+JNI_TEST(CompileAndRunCriticalNativeLongMethod)
+
+jdouble Java_MyClassNatives_criticalDFID(jdouble d1, jfloat f1, jint i1, jdouble d2) {
+  gJava_MyClassNatives_critical_state = Thread::Current()->GetState();
+  EXPECT_EQ(1.5, d1);
+  EXPECT_EQ(2.25f, f1);
+  EXPECT_EQ(3, i1);
+  EXPECT_EQ(-4.75, d2);
+  return d1 * 2 - f1 * i1 + d2;
+}
+
+void JniCompilerTest::CompileAndRunCriticalNativeDoubleMethodImpl() {
+  TEST_DISABLED_FOR_PORTABLE();
+  SetUpForTest(true, "criticalDFID", "(DFID)D",
+               reinterpret_cast<void*>(&Java_MyClassNatives_criticalDFID));
+
+  gJava_MyClassNatives_critical_state = kTerminated;
+  jdouble result = env_->CallStaticDoubleMethod(jklass_, jmethod_, 1.5, 2.25f, 3, -4.75);
+  EXPECT_EQ(-8.5, result);
+  EXPECT_EQ(check_generic_jni_ ? kNative : kRunnable, gJava_MyClassNatives_critical_state);
+}
+
+JNI_TEST(CompileAndRunCriticalNativeDoubleMethod)
+
 int gJava_MyClassNatives_fooSIOO_calls = 0;
 jobject Java_MyClassNatives_fooSIOO(JNIEnv* env, jclass klass, jint x, jobject y,
                              jobject z) {
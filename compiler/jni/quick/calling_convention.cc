@@ -101,20 +101,26 @@ bool ManagedRuntimeCallingConvention::IsCurrentParamALong() {
 // JNI calling convention
 
 JniCallingConvention* JniCallingConvention::Create(bool is_static, bool is_synchronized,
+                                                   bool is_critical_native,
                                                    const char* shorty,
                                                    InstructionSet instruction_set) {
   switch (instruction_set) {
     case kArm:
     case kThumb2:
-      return new arm::ArmJniCallingConvention(is_static, is_synchronized, shorty);
+      return new arm::ArmJniCallingConvention(is_static, is_synchronized, is_critical_native,
+                                              shorty);
     case kArm64:
-      return new arm64::Arm64JniCallingConvention(is_static, is_synchronized, shorty);
+      return new arm64::Arm64JniCallingConvention(is_static, is_synchronized, is_critical_native,
+                                                  shorty);
     case kMips:
-      return new mips::MipsJniCallingConvention(is_static, is_synchronized, shorty);
+      return new mips::MipsJniCallingConvention(is_static, is_synchronized, is_critical_native,
+                                                shorty);
     case kX86:
-      return new x86::X86JniCallingConvention(is_static, is_synchronized, shorty);
+      return new x86::X86JniCallingConvention(is_static, is_synchronized, is_critical_native,
+                                              shorty);
     case kX86_64:
-      return new x86_64::X86_64JniCallingConvention(is_static, is_synchronized, shorty);
+      return new x86_64::X86_64JniCallingConvention(is_static, is_synchronized,
+                                                    is_critical_native, shorty);
     default:
       LOG(FATAL) << "Unknown InstructionSet: " << instruction_set;
       return NULL;
@@ -122,7 +128,8 @@ JniCallingConvention* JniCallingConvention::Create(bool is_static, bool is_synch
 }
 
 size_t JniCallingConvention::ReferenceCount() const {
-  return NumReferenceArgs() + (IsStatic() ? 1 : 0);
+  // Critical natives have no reference arguments and don't pass the jclass.
+  return NumReferenceArgs() + ((IsStatic() && !IsCriticalNative()) ? 1 : 0);
 }
 
 FrameOffset JniCallingConvention::SavedLocalReferenceCookieOffset() const {
@@ -136,7 +143,7 @@ FrameOffset JniCallingConvention::ReturnValueSaveLocation() const {
 }
 
 bool JniCallingConvention::HasNext() {
-  if (itr_args_ <= kObjectOrClass) {
+  if (!IsCriticalNative() && itr_args_ <= kObjectOrClass) {
     return true;
   } else {
     unsigned int arg_pos = itr_args_ - NumberOfExtraArgumentsForJni();
@@ -146,7 +153,7 @@ bool JniCallingConvention::HasNext() {
 
 void JniCallingConvention::Next() {
   CHECK(HasNext());
-  if (itr_args_ > kObjectOrClass) {
+  if (IsCriticalNative() || itr_args_ > kObjectOrClass) {
     int arg_pos = itr_args_ - NumberOfExtraArgumentsForJni();
     if (IsParamALongOrDouble(arg_pos)) {
       itr_longs_and_doubles_++;
@@ -164,6 +171,9 @@ void JniCallingConvention::Next() {
 }
 
 bool JniCallingConvention::IsCurrentParamAReference() {
+  if (IsCriticalNative()) {
+    return IsParamAReference(itr_args_);
+  }
   switch (itr_args_) {
     case kJniEnv:
       return false;  // JNIEnv*
@@ -177,10 +187,13 @@ bool JniCallingConvention::IsCurrentParamAReference() {
 }
 
 bool JniCallingConvention::IsCurrentParamJniEnv() {
-  return (itr_args_ == kJniEnv);
+  return !IsCriticalNative() && (itr_args_ == kJniEnv);
 }
 
 bool JniCallingConvention::IsCurrentParamAFloatOrDouble() {
+  if (IsCriticalNative()) {
+    return IsParamAFloatOrDouble(itr_args_);
+  }
   switch (itr_args_) {
     case kJniEnv:
       return false;  // JNIEnv*
@@ -194,6 +207,9 @@ bool JniCallingConvention::IsCurrentParamAFloatOrDouble() {
 }
 
 bool JniCallingConvention::IsCurrentParamADouble() {
+  if (IsCriticalNative()) {
+    return IsParamADouble(itr_args_);
+  }
   switch (itr_args_) {
     case kJniEnv:
       return false;  // JNIEnv*
@@ -207,6 +223,9 @@ bool JniCallingConvention::IsCurrentParamADouble() {
 }
 
 bool JniCallingConvention::IsCurrentParamALong() {
+  if (IsCriticalNative()) {
+    return IsParamALong(itr_args_);
+  }
   switch (itr_args_) {
     case kJniEnv:
       return false;  // JNIEnv*
@@ -230,7 +249,7 @@ FrameOffset JniCallingConvention::CurrentParamHandleScopeEntryOffset() {
 }
 
 size_t JniCallingConvention::CurrentParamSize() {
-  if (itr_args_ <= kObjectOrClass) {
+  if (!IsCriticalNative() && itr_args_ <= kObjectOrClass) {
     return frame_pointer_size_;  // JNIEnv or jobject/jclass
   } else {
     int arg_pos = itr_args_ - NumberOfExtraArgumentsForJni();
@@ -239,6 +258,10 @@ size_t JniCallingConvention::CurrentParamSize() {
 }
 
 size_t JniCallingConvention::NumberOfExtraArgumentsForJni() {
+  if (IsCriticalNative()) {
+    // Critical natives are passed the managed arguments only.
+    return 0;
+  }
   // The first argument is the JNIEnv*.
   // Static methods have an extra argument which is the jclass.
   return IsStatic() ? 2 : 1;
@@ -270,9 +270,15 @@ class ManagedRuntimeCallingConvention : public CallingConvention {
 // callee saves for frames above this one.
 class JniCallingConvention : public CallingConvention {
  public:
-  static JniCallingConvention* Create(bool is_static, bool is_synchronized, const char* shorty,
+  static JniCallingConvention* Create(bool is_static, bool is_synchronized,
+                                      bool is_critical_native, const char* shorty,
                                       InstructionSet instruction_set);
 
+  // Critical natives take neither a JNIEnv* nor a jclass, only the primitive arguments.
+  bool IsCriticalNative() const {
+    return is_critical_native_;
+  }
+
   // Size of frame excluding space for outgoing args (its assumed Method* is
   // always at the bottom of a frame, but this doesn't work for outgoing
   // native args). Includes alignment.
@@ -347,9 +353,10 @@ class JniCallingConvention : public CallingConvention {
     kObjectOrClass = 1
   };
 
-  explicit JniCallingConvention(bool is_static, bool is_synchronized, const char* shorty,
-                                size_t frame_pointer_size)
-      : CallingConvention(is_static, is_synchronized, shorty, frame_pointer_size) {}
+  explicit JniCallingConvention(bool is_static, bool is_synchronized, bool is_critical_native,
+                                const char* shorty, size_t frame_pointer_size)
+      : CallingConvention(is_static, is_synchronized, shorty, frame_pointer_size),
+        is_critical_native_(is_critical_native) {}
 
   // Number of stack slots for outgoing arguments, above which the handle scope is
   // located
@@ -357,6 +364,9 @@ class JniCallingConvention : public CallingConvention {
 
  protected:
   size_t NumberOfExtraArgumentsForJni();
+
+ private:
+  const bool is_critical_native_;
 };
 
 }  // namespace art
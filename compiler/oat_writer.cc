@@ -454,6 +454,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
 
       if (kIsDebugBuild) {
         // We expect GC maps except when the class hasn't been verified or the method is native.
+        // Optimized code has none either: its stack maps are in the vmap table.
         const CompilerDriver* compiler_driver = writer_->compiler_driver_;
         ClassReference class_ref(dex_file_, class_def_index_);
         CompiledClass* compiled_class = compiler_driver->GetCompiledClass(class_ref);
@@ -468,7 +469,10 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
         const SwapVector<uint8_t>& gc_map = compiled_method->GetGcMap();
         size_t gc_map_size = gc_map.size() * sizeof(gc_map[0]);
         bool is_native = it.MemberIsNative();
-        CHECK(gc_map_size != 0 || is_native || status < mirror::Class::kStatusVerified)
+        bool is_optimized = compiled_method->GetMappingTable().empty() &&
+            !compiled_method->GetVmapTable().empty();
+        CHECK(gc_map_size != 0 || is_native || is_optimized ||
+              status < mirror::Class::kStatusVerified)
             << &gc_map << " " << gc_map_size << " " << (is_native ? "true" : "false") << " "
             << (status < mirror::Class::kStatusVerified) << " " << status << " "
             << PrettyMethod(it.GetMemberIndex(), *dex_file_);
@@ -99,6 +99,8 @@ class CodeGenerator : public ArenaObject {
   void ComputeFrameSize(size_t number_of_spill_slots);
   virtual size_t FrameEntrySpillSize() const = 0;
   int32_t GetStackSlot(HLocal* local) const;
+  // Stack slot of dex register `reg_number` when it lives in the frame, as in baseline code.
+  int32_t GetStackSlot(uint16_t reg_number) const;
   Location GetTemporaryLocation(HTemporary* temp) const;
 
   uint32_t GetFrameSize() const { return frame_size_; }
@@ -126,9 +128,9 @@ class CodeGenerator : public ArenaObject {
 
   void GenerateSlowPaths();
 
-  void BuildMappingTable(std::vector<uint8_t>* vector) const;
-  void BuildVMapTable(std::vector<uint8_t>* vector) const;
-  void BuildNativeGCMap(
+  // Encodes a CodeInfo (see runtime/stack_map.h) with one stack map per recorded pc.
+  // The runtime finds it where quick code keeps its vmap table.
+  void BuildStackMaps(
       std::vector<uint8_t>* vector, const DexCompilationUnit& dex_compilation_unit) const;
 
   bool IsLeafMethod() const {
@@ -160,12 +160,10 @@ CompiledMethod* OptimizingCompiler::TryCompile(const DexFile::CodeItem* code_ite
     visualizer.DumpGraph(kLivenessPassName);
   }
 
-  std::vector<uint8_t> mapping_table;
-  codegen->BuildMappingTable(&mapping_table);
-  std::vector<uint8_t> vmap_table;
-  codegen->BuildVMapTable(&vmap_table);
-  std::vector<uint8_t> gc_map;
-  codegen->BuildNativeGCMap(&gc_map, dex_compilation_unit);
+  // The stack maps replace the mapping table, the vmap table and the GC map. The runtime
+  // recognizes optimized code by its missing GC map.
+  std::vector<uint8_t> stack_maps;
+  codegen->BuildStackMaps(&stack_maps, dex_compilation_unit);
 
   return CompiledMethod::SwapAllocCompiledMethod(GetCompilerDriver(),
                                                  instruction_set,
@@ -173,9 +171,9 @@ CompiledMethod* OptimizingCompiler::TryCompile(const DexFile::CodeItem* code_ite
                                                  codegen->GetFrameSize(),
                                                  codegen->GetCoreSpillMask(),
                                                  0, /* FPR spill mask, unused */
-                                                 ArrayRef<const uint8_t>(mapping_table),
-                                                 ArrayRef<const uint8_t>(vmap_table),
-                                                 ArrayRef<const uint8_t>(gc_map),
+                                                 ArrayRef<const uint8_t>(),
+                                                 ArrayRef<const uint8_t>(stack_maps),
+                                                 ArrayRef<const uint8_t>(),
                                                  ArrayRef<const uint8_t>());
 }
 
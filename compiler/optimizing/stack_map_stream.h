@@ -147,6 +147,7 @@ class StackMapStream : public ValueObject {
       ComputeInlineInfoStart(),
       ComputeInlineInfoSize());
 
+    code_info.SetOverallSize(region.size());
     code_info.SetNumberOfStackMaps(stack_maps_.Size());
     code_info.SetStackMaskSize(stack_mask_size);
 
@@ -47,6 +47,7 @@ TEST(StackMapTest, Test1) {
   stream.FillIn(region);
 
   CodeInfo<size_t> code_info(region);
+  ASSERT_EQ(size, code_info.GetOverallSize());
   ASSERT_EQ(0u, code_info.GetStackMaskSize());
   ASSERT_EQ(1u, code_info.GetNumberOfStackMaps());
 
@@ -131,4 +132,35 @@ TEST(StackMapTest, Test2) {
   ASSERT_FALSE(stack_map.HasInlineInfo());
 }
 
+TEST(StackMapTest, LookupByNativePc) {
+  ArenaPool pool;
+  ArenaAllocator arena(&pool);
+  StackMapStream<uint32_t> stream(&arena);
+
+  ArenaBitVector sp_mask(&arena, 0, false);
+  const size_t kNumberOfStackMaps = 9;
+  for (size_t i = 0; i < kNumberOfStackMaps; ++i) {
+    stream.AddStackMapEntry(i, 16 * (i + 1), 0, &sp_mask, 0, 0);
+  }
+
+  size_t size = stream.ComputeNeededSize();
+  void* memory = arena.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillIn(region);
+
+  // The size is recovered from the encoded data alone.
+  CodeInfo<uint32_t> code_info(static_cast<const void*>(memory));
+  ASSERT_EQ(size, code_info.GetOverallSize());
+  ASSERT_EQ(kNumberOfStackMaps, code_info.GetNumberOfStackMaps());
+
+  for (size_t i = 0; i < kNumberOfStackMaps; ++i) {
+    ASSERT_EQ(i, code_info.FindStackMapIndexForNativePc(16 * (i + 1)));
+    ASSERT_EQ(i, code_info.FindStackMapIndexForDexPc(i));
+    ASSERT_EQ(CodeInfo<uint32_t>::kNoStackMap,
+              code_info.FindStackMapIndexForNativePc(16 * (i + 1) + 1));
+  }
+  ASSERT_EQ(CodeInfo<uint32_t>::kNoStackMap, code_info.FindStackMapIndexForNativePc(0));
+  ASSERT_EQ(CodeInfo<uint32_t>::kNoStackMap, code_info.FindStackMapIndexForDexPc(42));
+}
+
 }  // namespace art
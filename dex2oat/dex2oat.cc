@@ -25,6 +25,10 @@
 #include <string>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
 #if defined(__linux__) && defined(__arm__)
 #include <sys/personality.h>
 #include <sys/utsname.h>
@@ -836,6 +840,36 @@ static bool UseSwap(bool is_image, std::vector<const DexFile*>& dex_files) {
   return dex_files_size >= kMinDexFileCumulativeSizeForSwap;
 }
 
+// Copies all of in to out, which are both positioned at their start. Uses sendfile where
+// available so the data does not go through user space.
+static bool CopyFile(File* in, File* out) {
+#ifdef __linux__
+  while (true) {
+    ssize_t bytes_sent = TEMP_FAILURE_RETRY(sendfile(out->Fd(), in->Fd(), nullptr, 1 * GB));
+    if (bytes_sent == 0) {
+      return true;
+    }
+    if (bytes_sent < 0) {
+      if (errno == EINVAL || errno == ENOSYS) {
+        break;  // Not supported for these files, copy by hand.
+      }
+      return false;
+    }
+  }
+#endif
+  const size_t kBufferSize = 1 * MB;
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[kBufferSize]);
+  while (true) {
+    ssize_t bytes_read = TEMP_FAILURE_RETRY(read(in->Fd(), buffer.get(), kBufferSize));
+    if (bytes_read <= 0) {
+      return bytes_read == 0;
+    }
+    if (!out->WriteFully(buffer.get(), bytes_read)) {
+      return false;
+    }
+  }
+}
+
 static int dex2oat(int argc, char** argv) {
   b13564922();
 
@@ -1665,15 +1699,10 @@ static int dex2oat(int argc, char** argv) {
     }
     std::unique_ptr<File> in(OS::OpenFileForReading(oat_unstripped.c_str()));
     std::unique_ptr<File> out(OS::CreateEmptyFile(oat_stripped.c_str()));
-    size_t buffer_size = 8192;
-    std::unique_ptr<uint8_t> buffer(new uint8_t[buffer_size]);
-    while (true) {
-      int bytes_read = TEMP_FAILURE_RETRY(read(in->Fd(), buffer.get(), buffer_size));
-      if (bytes_read <= 0) {
-        break;
-      }
-      bool write_ok = out->WriteFully(buffer.get(), bytes_read);
-      CHECK(write_ok);
+    if (!CopyFile(in.get(), out.get())) {
+      PLOG(ERROR) << "Failed to copy " << oat_unstripped << " to " << oat_stripped;
+      out->Erase();
+      return EXIT_FAILURE;
     }
     oat_file.reset(out.release());
     VLOG(compiler) << "Oat file copied successfully (stripped): " << oat_stripped;
@@ -17,8 +17,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -50,7 +53,9 @@
 #include "runtime.h"
 #include "safe_map.h"
 #include "scoped_thread_state_change.h"
+#include "stack_map.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "verifier/dex_gc_map.h"
 #include "verifier/method_verifier.h"
 #include "vmap_table.h"
@@ -102,6 +107,16 @@ static void usage() {
           "  --no-disassemble may be used to disable disassembly.\n"
           "      Example: --no-disassemble\n"
           "\n");
+  fprintf(stderr,
+          "  -j<number>: dump the dex files of the oat file on this many threads. Only used\n"
+          "      when dumping an image, as dumping an oat file on its own runs without a runtime.\n"
+          "      Example: -j4\n"
+          "\n");
+  fprintf(stderr,
+          "  --size-report=<file.csv>: write the bytes of code, mapping tables, vmap tables,\n"
+          "      GC maps and image objects attributed to each method, class and package.\n"
+          "      Example: --size-report=/tmp/boot-sizes.csv\n"
+          "\n");
   exit(EXIT_FAILURE);
 }
 
@@ -123,18 +138,92 @@ class OatDumperOptions {
                    bool dump_raw_gc_map,
                    bool dump_vmap,
                    bool disassemble_code,
-                   bool absolute_addresses)
+                   bool absolute_addresses,
+                   size_t thread_count)
     : dump_raw_mapping_table_(dump_raw_mapping_table),
       dump_raw_gc_map_(dump_raw_gc_map),
       dump_vmap_(dump_vmap),
       disassemble_code_(disassemble_code),
-      absolute_addresses_(absolute_addresses) {}
+      absolute_addresses_(absolute_addresses),
+      thread_count_(thread_count) {}
 
   const bool dump_raw_mapping_table_;
   const bool dump_raw_gc_map_;
   const bool dump_vmap_;
   const bool disassemble_code_;
   const bool absolute_addresses_;
+  const size_t thread_count_;
+};
+
+// Bytes attributed to methods, classes and packages, written out as CSV. Methods are written as
+// they are added, classes and packages are totalled and written by Finish.
+class SizeReport {
+ public:
+  struct Sizes {
+    Sizes() : code(0), mapping_table(0), vmap_table(0), gc_map(0), objects(0) {}
+
+    void Add(const Sizes& other) {
+      code += other.code;
+      mapping_table += other.mapping_table;
+      vmap_table += other.vmap_table;
+      gc_map += other.gc_map;
+      objects += other.objects;
+    }
+
+    size_t code;
+    size_t mapping_table;
+    size_t vmap_table;
+    size_t gc_map;
+    size_t objects;
+  };
+
+  explicit SizeReport(std::ostream* os) : os_(os) {
+    *os_ << "kind,name,code_bytes,mapping_table_bytes,vmap_table_bytes,gc_map_bytes,"
+         << "object_bytes\n";
+  }
+
+  void AddMethod(const std::string& name, const char* class_descriptor, const Sizes& sizes) {
+    WriteRow("method", name, sizes);
+    AddClass(class_descriptor, sizes);
+  }
+
+  void AddClass(const char* descriptor, const Sizes& sizes) {
+    classes_[descriptor].Add(sizes);
+  }
+
+  void Finish() {
+    std::map<std::string, Sizes> packages;
+    for (const auto& entry : classes_) {
+      WriteRow("class", PrettyDescriptor(entry.first.c_str()), entry.second);
+      packages[PackageOf(entry.first)].Add(entry.second);
+    }
+    for (const auto& entry : packages) {
+      WriteRow("package", entry.first, entry.second);
+    }
+    *os_ << std::flush;
+  }
+
+ private:
+  // Arrays count towards the package of their element type, primitive types have no package.
+  static std::string PackageOf(const std::string& descriptor) {
+    size_t begin = descriptor.find_first_not_of('[');
+    size_t end = descriptor.rfind('/');
+    if (begin == std::string::npos || descriptor[begin] != 'L' || end == std::string::npos) {
+      return "";
+    }
+    std::string package = descriptor.substr(begin + 1, end - begin - 1);
+    std::replace(package.begin(), package.end(), '/', '.');
+    return package;
+  }
+
+  void WriteRow(const char* kind, const std::string& name, const Sizes& sizes) {
+    // Method names have commas in their signatures, and so are quoted.
+    *os_ << kind << ",\"" << name << "\"," << sizes.code << "," << sizes.mapping_table << ","
+         << sizes.vmap_table << "," << sizes.gc_map << "," << sizes.objects << "\n";
+  }
+
+  std::ostream* const os_;
+  std::map<std::string, Sizes> classes_;
 };
 
 class OatDumper {
@@ -144,9 +233,7 @@ class OatDumper {
       oat_dex_files_(oat_file.GetOatDexFiles()),
       options_(options),
       instruction_set_(oat_file_.GetOatHeader().GetInstructionSet()),
-      disassembler_(Disassembler::Create(instruction_set_,
-                                         new DisassemblerOptions(options_->absolute_addresses_,
-                                                                 oat_file.Begin()))) {
+      disassembler_(CreateDisassembler()) {
     AddAllOffsets();
   }
 
@@ -246,17 +333,65 @@ class OatDumper {
 
     os << std::flush;
 
-    for (size_t i = 0; i < oat_dex_files_.size(); i++) {
-      const OatFile::OatDexFile* oat_dex_file = oat_dex_files_[i];
-      CHECK(oat_dex_file != nullptr);
-      if (!DumpOatDexFile(os, *oat_dex_file)) {
+    // The verifier output needs a runtime, and so do the threads of a thread pool.
+    if (options_->thread_count_ > 1 && Runtime::Current() != nullptr) {
+      if (!DumpOatDexFilesInParallel(os)) {
         success = false;
       }
+    } else {
+      for (size_t i = 0; i < oat_dex_files_.size(); i++) {
+        const OatFile::OatDexFile* oat_dex_file = oat_dex_files_[i];
+        CHECK(oat_dex_file != nullptr);
+        if (!DumpOatDexFile(os, *oat_dex_file, disassembler_)) {
+          success = false;
+        }
+      }
     }
     os << std::flush;
     return success;
   }
 
+  // Adds the code and tables of every compiled method. Code and tables shared by several methods
+  // are attributed to the first of them.
+  void AddToSizeReport(SizeReport* report) {
+    std::set<uintptr_t> seen;
+    for (const OatFile::OatDexFile* oat_dex_file : oat_dex_files_) {
+      CHECK(oat_dex_file != nullptr);
+      std::string error_msg;
+      std::unique_ptr<const DexFile> dex_file(oat_dex_file->OpenDexFile(&error_msg));
+      if (dex_file.get() == nullptr) {
+        LOG(WARNING) << "Failed to open dex file '" << oat_dex_file->GetDexFileLocation()
+            << "': " << error_msg;
+        continue;
+      }
+      for (size_t class_def_index = 0;
+           class_def_index < dex_file->NumClassDefs();
+           class_def_index++) {
+        const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+        const byte* class_data = dex_file->GetClassData(class_def);
+        if (class_data == nullptr) {
+          continue;
+        }
+        const char* descriptor = dex_file->GetClassDescriptor(class_def);
+        const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(class_def_index);
+        ClassDataItemIterator it(*dex_file, class_data);
+        SkipAllFields(it);
+        for (uint32_t class_method_index = 0; it.HasNext(); class_method_index++, it.Next()) {
+          const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+          SizeReport::Sizes sizes;
+          const void* code = oat_method.GetQuickCode();
+          if (code != nullptr && seen.insert(AlignCodeOffset(oat_method.GetCodeOffset())).second) {
+            sizes.code = oat_method.GetQuickCodeSize();
+          }
+          sizes.mapping_table = UnseenSize(oat_method.GetMappingTable(), &seen);
+          sizes.vmap_table = UnseenSize(oat_method.GetVmapTable(), &seen);
+          sizes.gc_map = UnseenSize(oat_method.GetGcMap(), &seen);
+          report->AddMethod(PrettyMethod(it.GetMemberIndex(), *dex_file, true), descriptor, sizes);
+        }
+      }
+    }
+  }
+
   size_t ComputeSize(const void* oat_data) {
     if (reinterpret_cast<const byte*>(oat_data) < oat_file_.Begin() ||
         reinterpret_cast<const byte*>(oat_data) > oat_file_.End()) {
@@ -299,6 +434,74 @@ class OatDumper {
   }
 
  private:
+  // Dumps a dex file into a buffer of its own.
+  class DumpOatDexFileTask : public Task {
+   public:
+    DumpOatDexFileTask(OatDumper* dumper, const OatFile::OatDexFile* oat_dex_file)
+        : dumper_(dumper), oat_dex_file_(oat_dex_file), success_(false) {}
+
+    void Run(Thread* self) OVERRIDE {
+      // Disassemblers keep state between instructions, so every task needs its own.
+      std::unique_ptr<Disassembler> disassembler(dumper_->CreateDisassembler());
+      success_ = dumper_->DumpOatDexFile(output_, *oat_dex_file_, disassembler.get());
+    }
+
+    std::string GetOutput() const {
+      return output_.str();
+    }
+
+    bool GetSuccess() const {
+      return success_;
+    }
+
+   private:
+    OatDumper* const dumper_;
+    const OatFile::OatDexFile* const oat_dex_file_;
+    std::ostringstream output_;
+    bool success_;
+  };
+
+  Disassembler* CreateDisassembler() {
+    return Disassembler::Create(instruction_set_,
+                                new DisassemblerOptions(options_->absolute_addresses_,
+                                                        oat_file_.Begin()));
+  }
+
+  // Dumps the dex files on a thread pool, then writes them out in order. Each dex file is
+  // buffered in full, so this trades memory for time.
+  bool DumpOatDexFilesInParallel(std::ostream& os) {
+    std::vector<std::unique_ptr<DumpOatDexFileTask>> tasks;
+    {
+      // The workers may need the GC to run while this thread waits for them.
+      Thread* self = Thread::Current();
+      ScopedThreadStateChange tsc(self, kNative);
+      ThreadPool thread_pool("oatdump thread pool", options_->thread_count_);
+      for (const OatFile::OatDexFile* oat_dex_file : oat_dex_files_) {
+        CHECK(oat_dex_file != nullptr);
+        tasks.emplace_back(new DumpOatDexFileTask(this, oat_dex_file));
+        thread_pool.AddTask(self, tasks.back().get());
+      }
+      thread_pool.StartWorkers(self);
+      thread_pool.Wait(self, false, false);
+    }
+    bool success = true;
+    for (const std::unique_ptr<DumpOatDexFileTask>& task : tasks) {
+      os << task->GetOutput() << std::flush;
+      if (!task->GetSuccess()) {
+        success = false;
+      }
+    }
+    return success;
+  }
+
+  // The size of the oat data starting at oat_data, or 0 if it was already counted.
+  size_t UnseenSize(const void* oat_data, std::set<uintptr_t>* seen) {
+    if (oat_data == nullptr || !seen->insert(reinterpret_cast<uintptr_t>(oat_data)).second) {
+      return 0;
+    }
+    return ComputeSize(oat_data);
+  }
+
   void AddAllOffsets() {
     // We don't know the length of the code for each method, but we need to know where to stop
     // when disassembling. What we do know is that a region of code will be followed by some other
@@ -358,7 +561,8 @@ class OatDumper {
     offsets_.insert(oat_method.GetGcMapOffset());
   }
 
-  bool DumpOatDexFile(std::ostream& os, const OatFile::OatDexFile& oat_dex_file) {
+  bool DumpOatDexFile(std::ostream& os, const OatFile::OatDexFile& oat_dex_file,
+                      Disassembler* disassembler) {
     bool success = true;
     os << "OatDexFile:\n";
     os << StringPrintf("location: %s\n", oat_dex_file.GetDexFileLocation().c_str());
@@ -387,7 +591,7 @@ class OatDumper {
       // TODO: include bitmap here if type is kOatClassSomeCompiled?
       Indenter indent_filter(os.rdbuf(), kIndentChar, kIndentBy1Count);
       std::ostream indented_os(&indent_filter);
-      if (!DumpOatClass(indented_os, oat_class, *(dex_file.get()), class_def)) {
+      if (!DumpOatClass(indented_os, oat_class, *(dex_file.get()), class_def, disassembler)) {
         success = false;
       }
     }
@@ -406,7 +610,7 @@ class OatDumper {
   }
 
   bool DumpOatClass(std::ostream& os, const OatFile::OatClass& oat_class, const DexFile& dex_file,
-                    const DexFile::ClassDef& class_def) {
+                    const DexFile::ClassDef& class_def, Disassembler* disassembler) {
     bool success = true;
     const byte* class_data = dex_file.GetClassData(class_def);
     if (class_data == nullptr) {  // empty class such as a marker interface?
@@ -419,7 +623,7 @@ class OatDumper {
     while (it.HasNextDirectMethod()) {
       if (!DumpOatMethod(os, class_def, class_method_index, oat_class, dex_file,
                          it.GetMemberIndex(), it.GetMethodCodeItem(),
-                         it.GetRawMemberAccessFlags())) {
+                         it.GetRawMemberAccessFlags(), disassembler)) {
         success = false;
       }
       class_method_index++;
@@ -428,7 +632,7 @@ class OatDumper {
     while (it.HasNextVirtualMethod()) {
       if (!DumpOatMethod(os, class_def, class_method_index, oat_class, dex_file,
                          it.GetMemberIndex(), it.GetMethodCodeItem(),
-                         it.GetRawMemberAccessFlags())) {
+                         it.GetRawMemberAccessFlags(), disassembler)) {
         success = false;
       }
       class_method_index++;
@@ -448,7 +652,7 @@ class OatDumper {
                      uint32_t class_method_index,
                      const OatFile::OatClass& oat_class, const DexFile& dex_file,
                      uint32_t dex_method_idx, const DexFile::CodeItem* code_item,
-                     uint32_t method_access_flags) {
+                     uint32_t method_access_flags, Disassembler* disassembler) {
     bool success = true;
     os << StringPrintf("%d: %s (dex_method_idx=%d)\n",
                        class_method_index, PrettyMethod(dex_method_idx, dex_file, true).c_str(),
@@ -623,7 +827,8 @@ class OatDumper {
           success = false;
           if (options_->disassemble_code_) {
             if (code_size_offset + kPrologueBytes <= oat_file_.Size()) {
-              DumpCode(*indent2_os, verifier.get(), oat_method, code_item, true, kPrologueBytes);
+              DumpCode(*indent2_os, verifier.get(), oat_method, code_item, true, kPrologueBytes,
+                       disassembler);
             }
           }
         } else if (code_size > kMaxCodeSize) {
@@ -635,11 +840,12 @@ class OatDumper {
           success = false;
           if (options_->disassemble_code_) {
             if (code_size_offset + kPrologueBytes <= oat_file_.Size()) {
-              DumpCode(*indent2_os, verifier.get(), oat_method, code_item, true, kPrologueBytes);
+              DumpCode(*indent2_os, verifier.get(), oat_method, code_item, true, kPrologueBytes,
+                       disassembler);
             }
           }
         } else if (options_->disassemble_code_) {
-          DumpCode(*indent2_os, verifier.get(), oat_method, code_item, !success, 0);
+          DumpCode(*indent2_os, verifier.get(), oat_method, code_item, !success, 0, disassembler);
         }
       }
     }
@@ -672,7 +878,11 @@ class OatDumper {
 
   void DumpVmap(std::ostream& os, const OatFile::OatMethod& oat_method) {
     const uint8_t* raw_table = oat_method.GetVmapTable();
-    if (raw_table != nullptr) {
+    if (raw_table != nullptr && oat_method.GetGcMap() == nullptr &&
+        oat_method.GetMappingTable() == nullptr) {
+      // Optimized code keeps a CodeInfo in place of the vmap table.
+      DumpStackMaps(os, CodeInfo<uint32_t>(raw_table));
+    } else if (raw_table != nullptr) {
       const VmapTable vmap_table(raw_table);
       bool first = true;
       bool processing_fp = false;
@@ -697,6 +907,24 @@ class OatDumper {
     }
   }
 
+  void DumpStackMaps(std::ostream& os, CodeInfo<uint32_t> code_info) {
+    Indenter indent_filter(os.rdbuf(), kIndentChar, kIndentBy1Count);
+    std::ostream indent_os(&indent_filter);
+    os << "stack maps {\n";
+    for (size_t i = 0, e = code_info.GetNumberOfStackMaps(); i < e; ++i) {
+      StackMap<uint32_t> stack_map = code_info.GetStackMapAt(i);
+      indent_os << StringPrintf("0x%04x -> 0x%04x register_mask=0x%08x stack_mask=",
+                                stack_map.GetNativePc(), stack_map.GetDexPc(),
+                                stack_map.GetRegisterMask());
+      MemoryRegion stack_mask = stack_map.GetStackMask();
+      for (size_t bit = stack_mask.size_in_bits(); bit > 0; --bit) {
+        indent_os << (stack_mask.LoadBit(bit - 1) ? "1" : "0");
+      }
+      indent_os << "\n";
+    }
+    os << "}\n";
+  }
+
   void DescribeVReg(std::ostream& os, const OatFile::OatMethod& oat_method,
                     const DexFile::CodeItem* code_item, size_t reg, VRegKind kind) {
     const uint8_t* raw_table = oat_method.GetVmapTable();
@@ -919,7 +1147,7 @@ class OatDumper {
 
   void DumpCode(std::ostream& os, verifier::MethodVerifier* verifier,
                 const OatFile::OatMethod& oat_method, const DexFile::CodeItem* code_item,
-                bool bad_input, size_t code_size) {
+                bool bad_input, size_t code_size, Disassembler* disassembler) {
     const void* portable_code = oat_method.GetPortableCode();
     const void* quick_code = oat_method.GetQuickCode();
 
@@ -936,7 +1164,7 @@ class OatDumper {
         if (!bad_input) {
           DumpMappingAtOffset(os, oat_method, offset, false);
         }
-        offset += disassembler_->Dump(os, quick_native_pc + offset);
+        offset += disassembler->Dump(os, quick_native_pc + offset);
         if (!bad_input) {
           uint32_t dex_pc = DumpMappingAtOffset(os, oat_method, offset, true);
           if (dex_pc != DexFile::kDexNoIndex) {
@@ -1124,6 +1352,17 @@ class ImageDumper {
     return oat_dumper_->Dump(os);
   }
 
+  // Adds the oat file and the image objects, by class, to the report. Only valid after Dump.
+  void AddToSizeReport(SizeReport* report) {
+    CHECK(oat_dumper_.get() != nullptr);
+    oat_dumper_->AddToSizeReport(report);
+    for (const auto& sizes_and_count : stats_.sizes_and_counts) {
+      SizeReport::Sizes sizes;
+      sizes.objects = sizes_and_count.second.bytes;
+      report->AddClass(sizes_and_count.first.c_str(), sizes);
+    }
+  }
+
  private:
   static void PrettyObjectValue(std::ostream& os, mirror::Class* type, mirror::Object* value)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
@@ -1711,6 +1950,8 @@ static int oatdump(int argc, char** argv) {
   bool dump_raw_gc_map = false;
   bool dump_vmap = true;
   bool disassemble_code = true;
+  int thread_count = 1;
+  std::unique_ptr<std::ofstream> size_report_out;
 
   for (int i = 0; i < argc; i++) {
     const StringPiece option(argv[i]);
@@ -1741,6 +1982,20 @@ static int oatdump(int argc, char** argv) {
       dump_vmap = false;
     } else if (option == "--no-disassemble") {
       disassemble_code = false;
+    } else if (option.starts_with("-j")) {
+      const char* thread_count_str = option.substr(strlen("-j")).data();
+      if (!ParseInt(thread_count_str, &thread_count) || thread_count < 1) {
+        fprintf(stderr, "Failed to parse -j argument '%s' as a positive integer\n",
+                thread_count_str);
+        usage();
+      }
+    } else if (option.starts_with("--size-report=")) {
+      const char* filename = option.substr(strlen("--size-report=")).data();
+      size_report_out.reset(new std::ofstream(filename));
+      if (!size_report_out->good()) {
+        fprintf(stderr, "Failed to open size report filename %s\n", filename);
+        usage();
+      }
     } else if (option.starts_with("--output=")) {
       const char* filename = option.substr(strlen("--output=")).data();
       out.reset(new std::ofstream(filename));
@@ -1771,7 +2026,8 @@ static int oatdump(int argc, char** argv) {
                                                                             dump_raw_gc_map,
                                                                             dump_vmap,
                                                                             disassemble_code,
-                                                                            absolute_addresses));
+                                                                            absolute_addresses,
+                                                                            thread_count));
   MemMap::Init();
   if (oat_filename != nullptr) {
     std::string error_msg;
@@ -1783,6 +2039,11 @@ static int oatdump(int argc, char** argv) {
     }
     OatDumper oat_dumper(*oat_file, oat_dumper_options.release());
     bool success = oat_dumper.Dump(*os);
+    if (size_report_out.get() != nullptr) {
+      SizeReport size_report(size_report_out.get());
+      oat_dumper.AddToSizeReport(&size_report);
+      size_report.Finish();
+    }
     return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
@@ -1829,6 +2090,11 @@ static int oatdump(int argc, char** argv) {
   }
   ImageDumper image_dumper(os, *image_space, image_header, oat_dumper_options.release());
   bool success = image_dumper.Dump();
+  if (size_report_out.get() != nullptr) {
+    SizeReport size_report(size_report_out.get());
+    image_dumper.AddToSizeReport(&size_report);
+    size_report.Finish();
+  }
   return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
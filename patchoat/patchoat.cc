@@ -29,6 +29,7 @@
 #include "base/stringprintf.h"
 #include "elf_utils.h"
 #include "elf_file.h"
+#include "gc/accounting/space_bitmap-inl.h"
 #include "gc/space/image_space.h"
 #include "image.h"
 #include "instruction_set.h"
@@ -45,6 +46,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "zlib.h"
 #include "utils.h"
 
@@ -111,7 +113,7 @@ static bool LocationToFilename(const std::string& location, InstructionSet isa,
 
 bool PatchOat::Patch(const std::string& image_location, off_t delta,
                      File* output_image, InstructionSet isa,
-                     TimingLogger* timings) {
+                     size_t thread_count, TimingLogger* timings) {
   CHECK(Runtime::Current() == nullptr);
   CHECK(output_image != nullptr);
   CHECK_GE(output_image->Fd(), 0);
@@ -162,6 +164,8 @@ bool PatchOat::Patch(const std::string& image_location, off_t delta,
   // Runtime::Create acquired the mutator_lock_ that is normally given away when we Runtime::Start,
   // give it away now and then switch to a more manageable ScopedObjectAccess.
   Thread::Current()->TransitionFromRunnableToSuspended(kNative);
+  // The calling thread does its share of the work, so it is not counted in the pool.
+  ThreadPool thread_pool("patchoat thread pool", thread_count - 1);
   ScopedObjectAccess soa(Thread::Current());
 
   t.NewTiming("Image and oat Patching setup");
@@ -178,7 +182,7 @@ bool PatchOat::Patch(const std::string& image_location, off_t delta,
   gc::space::ImageSpace* ispc = Runtime::Current()->GetHeap()->GetImageSpace();
 
   PatchOat p(isa, image.release(), ispc->GetLiveBitmap(), ispc->GetMemMap(),
-             delta, timings);
+             delta, &thread_pool, timings);
   t.NewTiming("Patching files");
   if (!p.PatchImage()) {
     LOG(ERROR) << "Failed to patch image file " << input_image->GetPath();
@@ -194,7 +198,7 @@ bool PatchOat::Patch(const std::string& image_location, off_t delta,
 
 bool PatchOat::Patch(File* input_oat, const std::string& image_location, off_t delta,
                      File* output_oat, File* output_image, InstructionSet isa,
-                     TimingLogger* timings,
+                     size_t thread_count, TimingLogger* timings,
                      bool output_oat_opened_from_fd,
                      bool new_oat_out, bool input_oat_filename_dummy) {
   CHECK(Runtime::Current() == nullptr);
@@ -257,6 +261,8 @@ bool PatchOat::Patch(File* input_oat, const std::string& image_location, off_t d
   // Runtime::Create acquired the mutator_lock_ that is normally given away when we Runtime::Start,
   // give it away now and then switch to a more manageable ScopedObjectAccess.
   Thread::Current()->TransitionFromRunnableToSuspended(kNative);
+  // The calling thread does its share of the work, so it is not counted in the pool.
+  ThreadPool thread_pool("patchoat thread pool", thread_count - 1);
   ScopedObjectAccess soa(Thread::Current());
 
   t.NewTiming("Image and oat Patching setup");
@@ -298,7 +304,7 @@ bool PatchOat::Patch(File* input_oat, const std::string& image_location, off_t d
   }
 
   PatchOat p(isa, elf.release(), image.release(), ispc->GetLiveBitmap(), ispc->GetMemMap(),
-             delta, timings);
+             delta, &thread_pool, timings);
   t.NewTiming("Patching files");
   if (!skip_patching_oat && !p.PatchElf()) {
     LOG(ERROR) << "Failed to patch oat file " << input_oat->GetPath();
@@ -466,6 +472,70 @@ bool PatchOat::SymlinkOrCopy(File* input_oat,
   return true;
 }
 
+// Tasks per pool thread. Using more tasks than threads keeps the threads busy when parts of the
+// image or the code are denser than others.
+static constexpr size_t kTasksPerThread = 4;
+
+class PatchOat::PatchObjectsTask : public Task {
+ public:
+  PatchObjectsTask(PatchOat* patcher, uintptr_t begin, uintptr_t end)
+      : patcher_(patcher), begin_(begin), end_(end) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    patcher_->bitmap_->VisitMarkedRange(begin_, end_, *this);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+  void operator()(mirror::Object* obj) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    patcher_->VisitObject(obj);
+  }
+
+ private:
+  PatchOat* const patcher_;
+  const uintptr_t begin_;
+  const uintptr_t end_;
+};
+
+class PatchOat::PatchTextTask : public Task {
+ public:
+  PatchTextTask(PatchOat* patcher, const uintptr_t* begin, const uintptr_t* end)
+      : patcher_(patcher), begin_(begin), end_(end) {}
+
+  void Run(Thread* self) OVERRIDE {
+    Elf32_Shdr* oat_text_sec = patcher_->oat_file_->FindSectionByName(".text");
+    CHECK(oat_text_sec != nullptr);
+    byte* to_patch = patcher_->oat_file_->Begin() + oat_text_sec->sh_offset;
+    uintptr_t to_patch_end = reinterpret_cast<uintptr_t>(to_patch) + oat_text_sec->sh_size;
+    for (const uintptr_t* patches = begin_; patches < end_; patches++) {
+      CHECK_LT(*patches, oat_text_sec->sh_size) << "Bad Patch";
+      uint32_t* patch_loc = reinterpret_cast<uint32_t*>(to_patch + *patches);
+      CHECK_LT(reinterpret_cast<uintptr_t>(patch_loc), to_patch_end);
+      *patch_loc += patcher_->delta_;
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  PatchOat* const patcher_;
+  const uintptr_t* const begin_;
+  const uintptr_t* const end_;
+};
+
+void PatchOat::RunTasks() {
+  Thread* self = Thread::Current();
+  thread_pool_->StartWorkers(self);
+  // The caller may hold the mutator lock, which the workers only ever share.
+  thread_pool_->Wait(self, true, true);
+  thread_pool_->StopWorkers(self);
+}
+
 bool PatchOat::PatchImage() {
   ImageHeader* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
   CHECK_GT(image_->Size(), sizeof(ImageHeader));
@@ -481,9 +551,19 @@ bool PatchOat::PatchImage() {
 
   {
     TimingLogger::ScopedTiming t("Walk Bitmap", timings_);
-    // Walk the bitmap.
-    WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
-    bitmap_->Walk(PatchOat::BitmapCallback, this);
+    // Walk the bitmap, split up by address range. Objects only write to their own copy, so the
+    // ranges can be patched in parallel.
+    Thread* self = Thread::Current();
+    WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    uintptr_t begin = bitmap_->HeapBegin();
+    uintptr_t end = static_cast<uintptr_t>(bitmap_->HeapLimit());
+    size_t num_tasks = (thread_pool_->GetThreadCount() + 1) * kTasksPerThread;
+    uintptr_t chunk_size = RoundUp((end - begin + num_tasks - 1) / num_tasks, kPageSize);
+    for (uintptr_t chunk = begin; chunk < end; chunk += chunk_size) {
+      thread_pool_->AddTask(self, new PatchObjectsTask(this, chunk,
+                                                       std::min(chunk + chunk_size, end)));
+    }
+    RunTasks();
   }
   return true;
 }
@@ -541,7 +621,7 @@ const OatHeader* PatchOat::GetOatHeader(const ElfFile* elf_file) {
   return oat_header;
 }
 
-// Called by BitmapCallback
+// Called by PatchObjectsTask
 void PatchOat::VisitObject(mirror::Object* object) {
   mirror::Object* copy = RelocatedCopyOf(object);
   CHECK(copy != nullptr);
@@ -775,18 +855,23 @@ bool PatchOat::PatchTextSection() {
   CHECK_EQ(patches_sec->sh_type, SHT_OAT_PATCH) << "Unexpected type of .oat_patches";
   uintptr_t* patches = reinterpret_cast<uintptr_t*>(oat_file_->Begin() + patches_sec->sh_offset);
   uintptr_t* patches_end = patches + (patches_sec->sh_size/sizeof(uintptr_t));
-  Elf32_Shdr* oat_text_sec = oat_file_->FindSectionByName(".text");
-  CHECK(oat_text_sec != nullptr);
-  byte* to_patch = oat_file_->Begin() + oat_text_sec->sh_offset;
-  uintptr_t to_patch_end = reinterpret_cast<uintptr_t>(to_patch) + oat_text_sec->sh_size;
 
-  for (; patches < patches_end; patches++) {
-    CHECK_LT(*patches, oat_text_sec->sh_size) << "Bad Patch";
-    uint32_t* patch_loc = reinterpret_cast<uint32_t*>(to_patch + *patches);
-    CHECK_LT(reinterpret_cast<uintptr_t>(patch_loc), to_patch_end);
-    *patch_loc += delta_;
+  if (thread_pool_ == nullptr) {
+    // Patching only the oat file runs without a runtime, and so without a thread pool.
+    PatchTextTask task(this, patches, patches_end);
+    task.Run(nullptr);
+    return true;
   }
-
+  // Each location is patched exactly once, so the chunks do not overlap.
+  Thread* self = Thread::Current();
+  size_t num_patches = patches_end - patches;
+  size_t num_tasks = (thread_pool_->GetThreadCount() + 1) * kTasksPerThread;
+  size_t chunk_size = (num_patches + num_tasks - 1) / num_tasks;
+  for (size_t i = 0; i < num_patches; i += chunk_size) {
+    size_t chunk_end = std::min(i + chunk_size, num_patches);
+    thread_pool_->AddTask(self, new PatchTextTask(this, patches + i, patches + chunk_end));
+  }
+  RunTasks();
   return true;
 }
 
@@ -882,6 +967,9 @@ static void Usage(const char *fmt, ...) {
   UsageError("");
   UsageError("  --no-lock-output: Do not attempt to obtain a flock on output oat file.");
   UsageError("");
+  UsageError("  -j<number>: specifies the number of threads used for patching.");
+  UsageError("      Example: -j4");
+  UsageError("");
   UsageError("  --dump-timings: dump out patch timing information");
   UsageError("");
   UsageError("  --no-dump-timings: do not dump out patch timing information");
@@ -1060,6 +1148,7 @@ static int patchoat(int argc, char **argv) {
   std::string patched_image_location;
   bool dump_timings = kIsDebugBuild;
   bool lock_output = true;
+  int thread_count = sysconf(_SC_NPROCESSORS_CONF);
 
   for (int i = 0; i < argc; i++) {
     const StringPiece option(argv[i]);
@@ -1196,6 +1285,11 @@ static int patchoat(int argc, char **argv) {
       lock_output = true;
     } else if (option == "--no-lock-output") {
       lock_output = false;
+    } else if (option.starts_with("-j")) {
+      const char* thread_count_str = option.substr(strlen("-j")).data();
+      if (!ParseInt(thread_count_str, &thread_count) || thread_count < 1) {
+        Usage("Failed to parse -j argument '%s' as a positive integer", thread_count_str);
+      }
     } else if (option == "--dump-timings") {
       dump_timings = true;
     } else if (option == "--no-dump-timings") {
@@ -1456,7 +1550,7 @@ static int patchoat(int argc, char **argv) {
   if (have_image_files && have_oat_files) {
     TimingLogger::ScopedTiming pt("patch image and oat", &timings);
     ret = PatchOat::Patch(input_oat.get(), input_image_location, base_delta,
-                          output_oat.get(), output_image.get(), isa, &timings,
+                          output_oat.get(), output_image.get(), isa, thread_count, &timings,
                           output_oat_fd >= 0,  // was it opened from FD?
                           new_oat_out, input_oat_filename_dummy);
     // The order here doesn't matter. If the first one is successfully saved and the second one
@@ -1471,7 +1565,8 @@ static int patchoat(int argc, char **argv) {
     ret = ret && FinishFile(output_oat.get(), ret);
   } else if (have_image_files) {
     TimingLogger::ScopedTiming pt("patch image", &timings);
-    ret = PatchOat::Patch(input_image_location, base_delta, output_image.get(), isa, &timings);
+    ret = PatchOat::Patch(input_image_location, base_delta, output_image.get(), isa,
+                          thread_count, &timings);
     ret = ret && FinishFile(output_image.get(), ret);
   } else {
     CHECK(false);
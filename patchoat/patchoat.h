@@ -31,6 +31,7 @@ namespace art {
 
 class ImageHeader;
 class OatHeader;
+class ThreadPool;
 
 namespace mirror {
 class Object;
@@ -49,12 +50,12 @@ class PatchOat {
 
   // Patch only the image (art file)
   static bool Patch(const std::string& art_location, off_t delta, File* art_out, InstructionSet isa,
-                    TimingLogger* timings);
+                    size_t thread_count, TimingLogger* timings);
 
   // Patch both the image and the oat file
   static bool Patch(File* oat_in, const std::string& art_location,
                     off_t delta, File* oat_out, File* art_out, InstructionSet isa,
-                    TimingLogger* timings,
+                    size_t thread_count, TimingLogger* timings,
                     bool output_oat_opened_from_fd,  // Was this using --oatput-oat-fd ?
                     bool new_oat_out,                // Output oat was a new file created by us?
                     bool input_oat_filename_dummy);  // Input cannot be symlinked
@@ -62,16 +63,17 @@ class PatchOat {
  private:
   // Takes ownership only of the ElfFile. All other pointers are only borrowed.
   PatchOat(ElfFile* oat_file, off_t delta, TimingLogger* timings)
-      : oat_file_(oat_file), delta_(delta), isa_(kNone), timings_(timings) {}
+      : oat_file_(oat_file), delta_(delta), isa_(kNone), thread_pool_(nullptr),
+        timings_(timings) {}
   PatchOat(InstructionSet isa, MemMap* image, gc::accounting::ContinuousSpaceBitmap* bitmap,
-           MemMap* heap, off_t delta, TimingLogger* timings)
+           MemMap* heap, off_t delta, ThreadPool* thread_pool, TimingLogger* timings)
       : image_(image), bitmap_(bitmap), heap_(heap),
-        delta_(delta), isa_(isa), timings_(timings) {}
+        delta_(delta), isa_(isa), thread_pool_(thread_pool), timings_(timings) {}
   PatchOat(InstructionSet isa, ElfFile* oat_file, MemMap* image,
            gc::accounting::ContinuousSpaceBitmap* bitmap, MemMap* heap, off_t delta,
-           TimingLogger* timings)
+           ThreadPool* thread_pool, TimingLogger* timings)
       : oat_file_(oat_file), image_(image), bitmap_(bitmap), heap_(heap),
-        delta_(delta), isa_(isa), timings_(timings) {}
+        delta_(delta), isa_(isa), thread_pool_(thread_pool), timings_(timings) {}
   ~PatchOat() {}
 
   // Was the .art image at image_path made with --compile-pic ?
@@ -95,11 +97,6 @@ class PatchOat {
                             bool new_oat_out,  // Output oat was newly created?
                             bool make_copy);
 
-  static void BitmapCallback(mirror::Object* obj, void* arg)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
-    reinterpret_cast<PatchOat*>(arg)->VisitObject(obj);
-  }
-
   void VisitObject(mirror::Object* obj)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void FixupMethod(mirror::ArtMethod* object, mirror::ArtMethod* copy)
@@ -116,6 +113,9 @@ class PatchOat {
 
   bool PatchImage() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Runs the tasks added to thread_pool_, with the calling thread helping out.
+  void RunTasks();
+
   bool WriteElf(File* out);
   bool WriteImage(File* out);
 
@@ -141,6 +141,11 @@ class PatchOat {
     mirror::Object* copy_;
   };
 
+  // Patches the image objects that start in a range of the heap.
+  class PatchObjectsTask;
+  // Patches a range of the .oat_patches locations in .text.
+  class PatchTextTask;
+
   // The elf file we are patching.
   std::unique_ptr<ElfFile> oat_file_;
   // A mmap of the image we are patching. This is modified.
@@ -153,6 +158,9 @@ class PatchOat {
   off_t delta_;
   // Active instruction set, used to know the entrypoint size.
   const InstructionSet isa_;
+  // Used to split up the patching work, only available when there is a runtime. Image objects
+  // and patch locations are independent of each other, so they can be patched in any order.
+  ThreadPool* const thread_pool_;
 
   TimingLogger* timings_;
 
@@ -51,6 +51,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/accounting/mod_union_table.cc \
   gc/accounting/remembered_set.cc \
   gc/accounting/space_bitmap.cc \
+  gc/allocation_sampler.cc \
   gc/collector/concurrent_copying.cc \
   gc/collector/garbage_collector.cc \
   gc/collector/immune_region.cc \
@@ -78,6 +79,7 @@ LIBART_COMMON_SRC_FILES := \
   instrumentation.cc \
   intern_table.cc \
   interpreter/interpreter.cc \
+  interpreter/interpreter_cache.cc \
   interpreter/interpreter_common.cc \
   interpreter/interpreter_switch_impl.cc \
   jdwp/jdwp_event.cc \
@@ -89,6 +91,7 @@ LIBART_COMMON_SRC_FILES := \
   jdwp/object_registry.cc \
   jni_internal.cc \
   jobject_comparator.cc \
+  mapping_table_index.cc \
   mem_map.cc \
   memory_region.cc \
   method_helper.cc \
@@ -135,11 +138,13 @@ LIBART_COMMON_SRC_FILES := \
   offsets.cc \
   os_linux.cc \
   parsed_options.cc \
+  perf_map.cc \
   primitive.cc \
   quick_exception_handler.cc \
   quick/inline_method_analyser.cc \
   reference_table.cc \
   reflection.cc \
+  reflection_invoke_cache.cc \
   runtime.cc \
   signal_catcher.cc \
   stack.cc \
@@ -164,6 +169,7 @@ LIBART_COMMON_SRC_FILES := \
 
 LIBART_COMMON_SRC_FILES += \
   arch/context.cc \
+  arch/memchr16.cc \
   arch/memcmp16.cc \
   arch/arm/registers_arm.cc \
   arch/arm64/registers_arm64.cc \
@@ -228,6 +234,7 @@ LIBART_TARGET_SRC_FILES_arm64 := \
   arch/arm64/context_arm64.cc \
   arch/arm64/entrypoints_init_arm64.cc \
   arch/arm64/jni_entrypoints_arm64.S \
+  arch/arm64/memchr16_arm64.S \
   arch/arm64/memcmp16_arm64.S \
   arch/arm64/portable_entrypoints_arm64.S \
   arch/arm64/quick_entrypoints_arm64.S \
@@ -254,6 +261,7 @@ LIBART_SRC_FILES_x86_64 := \
   arch/x86_64/context_x86_64.cc \
   arch/x86_64/entrypoints_init_x86_64.cc \
   arch/x86_64/jni_entrypoints_x86_64.S \
+  arch/x86_64/memchr16_x86_64.S \
   arch/x86_64/memcmp16_x86_64.S \
   arch/x86_64/portable_entrypoints_x86_64.S \
   arch/x86_64/quick_entrypoints_x86_64.S \
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_ARCH_MEMCHR16_H_
+#define ART_RUNTIME_ARCH_MEMCHR16_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// memchr16 support: returns the index of the first occurrence of ch in s[0..count), or -1.
+//
+// As for memcmp16, this can either be optimized assembly code, in which case we expect a function
+// __memchr16, or generic C support. The x86-64 version picks an SSE2 or an AVX2 loop at runtime
+// based on the CPU features; the arm64 version uses NEON.
+//
+// In both cases, MemChr16 is declared.
+
+#if defined(__aarch64__) || defined(__x86_64__)
+
+extern "C" int32_t __memchr16(const uint16_t* s, uint16_t ch, size_t count);
+#define MemChr16 __memchr16
+
+#else
+
+// This is the generic inlined version.
+static inline int32_t MemChr16(const uint16_t* s, uint16_t ch, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (s[i] == ch) {
+      return static_cast<int32_t>(i);
+    }
+  }
+  return -1;
+}
+
+#endif
+
+namespace art {
+
+namespace testing {
+
+// A version that is exposed and relatively "close to the metal," so that memchr16_test can do
+// some reasonable testing. Without this, as __memchr16 is hidden, the test cannot access the
+// implementation.
+int32_t MemChr16Testing(const uint16_t* s, uint16_t ch, size_t count);
+
+}
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_ARCH_MEMCHR16_H_
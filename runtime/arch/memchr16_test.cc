@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "memchr16.h"
+
+class MemChr16Test : public testing::Test {
+};
+
+// A simple implementation to compare against.
+// Note: this version is equivalent to the generic one used when no optimized version is available.
+static int32_t memchr16_find(const uint16_t* s, uint16_t ch, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (s[i] == ch) {
+      return static_cast<int32_t>(i);
+    }
+  }
+  return -1;
+}
+
+static constexpr size_t kMaxLength = 100;
+
+// Exhaustive over lengths, start alignments and match positions, so that every block and tail
+// path of the vectorized versions gets exercised.
+TEST_F(MemChr16Test, AllPositions) {
+  uint16_t data[kMaxLength + 2];
+  for (size_t misalign = 0; misalign < 2; ++misalign) {
+    uint16_t* s = data + misalign;
+    for (size_t count = 0; count <= kMaxLength; ++count) {
+      for (size_t i = 0; i < kMaxLength + 2; ++i) {
+        data[i] = 0x1234;
+      }
+      ASSERT_EQ(-1, art::testing::MemChr16Testing(s, 0xffff, count)) << count;
+      for (size_t pos = 0; pos < count; ++pos) {
+        s[pos] = 0xffff;
+        // A second match later on must not be reported.
+        if (pos + 3 < count) {
+          s[pos + 3] = 0xffff;
+        }
+        ASSERT_EQ(static_cast<int32_t>(pos), art::testing::MemChr16Testing(s, 0xffff, count))
+            << "count=" << count << " pos=" << pos;
+        s[pos] = 0x1234;
+        if (pos + 3 < count) {
+          s[pos + 3] = 0x1234;
+        }
+      }
+      // A match just past the end must not be found.
+      s[count] = 0xffff;
+      ASSERT_EQ(-1, art::testing::MemChr16Testing(s, 0xffff, count)) << count;
+    }
+  }
+}
+
+TEST_F(MemChr16Test, Random) {
+  uint32_t seed = 0x1234;
+  uint16_t data[kMaxLength];
+  for (size_t round = 0; round < 100000; ++round) {
+    seed = seed * 48271 % 2147483647 + 13;
+    size_t count = seed % kMaxLength;
+    for (size_t i = 0; i < count; ++i) {
+      seed = seed * 48271 % 2147483647 + 13;
+      data[i] = static_cast<uint16_t>(seed % 16);
+    }
+    uint16_t ch = static_cast<uint16_t>(round % 16);
+    ASSERT_EQ(memchr16_find(data, ch, count), art::testing::MemChr16Testing(data, ch, count))
+        << "Run " << round << ", count=" << count;
+  }
+}
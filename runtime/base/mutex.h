@@ -76,6 +76,8 @@ enum LockLevel {
   kTransactionLogLock,
   kInternTableLock,
   kOatFileSecondaryLookupLock,
+  kMappingTableIndexLock,
+  kReflectionInvokeCacheLock,
   kDefaultMutexLevel,
   kMarkSweepLargeObjectLock,
   kPinTableLock,
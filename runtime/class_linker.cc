@@ -62,6 +62,7 @@
 #include "mirror/stack_trace_element.h"
 #include "mirror/string-inl.h"
 #include "os.h"
+#include "perf_map.h"
 #include "runtime.h"
 #include "entrypoints/entrypoint_utils.h"
 #include "ScopedLocalRef.h"
@@ -689,17 +690,34 @@ bool ClassLinker::GenerateOatFile(const char* dex_filename,
 }
 
 const OatFile* ClassLinker::RegisterOatFile(const OatFile* oat_file) {
-  WriterMutexLock mu(Thread::Current(), dex_lock_);
-  if (kIsDebugBuild) {
-    for (size_t i = 0; i < oat_files_.size(); ++i) {
-      CHECK_NE(oat_file, oat_files_[i]) << oat_file->GetLocation();
+  {
+    WriterMutexLock mu(Thread::Current(), dex_lock_);
+    if (kIsDebugBuild) {
+      for (size_t i = 0; i < oat_files_.size(); ++i) {
+        CHECK_NE(oat_file, oat_files_[i]) << oat_file->GetLocation();
+      }
     }
+    VLOG(class_linker) << "Registering " << oat_file->GetLocation();
+    oat_files_.push_back(oat_file);
+  }
+  PerfMap* perf_map = Runtime::Current()->GetPerfMap();
+  if (perf_map != nullptr) {
+    perf_map->AddOatFile(*oat_file);
   }
-  VLOG(class_linker) << "Registering " << oat_file->GetLocation();
-  oat_files_.push_back(oat_file);
   return oat_file;
 }
 
+void ClassLinker::AddOatFilesToPerfMap(PerfMap* perf_map) {
+  std::vector<const OatFile*> oat_files;
+  {
+    ReaderMutexLock mu(Thread::Current(), dex_lock_);
+    oat_files = oat_files_;
+  }
+  for (const OatFile* oat_file : oat_files) {
+    perf_map->AddOatFile(*oat_file);
+  }
+}
+
 OatFile& ClassLinker::GetImageOatFile(gc::space::ImageSpace* space) {
   VLOG(startup) << "ClassLinker::GetImageOatFile entering";
   OatFile* oat_file = space->ReleaseOatFile();
@@ -2949,6 +2967,10 @@ mirror::ArtMethod* ClassLinker::LoadMethod(Thread* self, const DexFile& dex_file
         access_flags |= kAccConstructor;
       }
     }
+  } else if (UNLIKELY((access_flags & kAccNative) != 0) &&
+             dex_file.IsCriticalNativeMethod(*klass->GetClassDef(), dex_method_idx, access_flags)) {
+    // Compiled stubs and the generic JNI trampoline must agree on the native signature.
+    access_flags |= kAccCriticalNative;
   }
   dst->SetAccessFlags(access_flags);
 
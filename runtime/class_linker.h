@@ -50,6 +50,7 @@ namespace mirror {
 
 class InternTable;
 template<class T> class ObjectLock;
+class PerfMap;
 class Runtime;
 class ScopedObjectAccessAlreadyRunnable;
 template<size_t kNumReferences> class PACKED(4) StackHandleScope;
@@ -240,6 +241,10 @@ class ClassLinker {
   const OatFile* RegisterOatFile(const OatFile* oat_file)
       LOCKS_EXCLUDED(dex_lock_);
 
+  // Adds the oat files registered so far to perf_map.
+  void AddOatFilesToPerfMap(PerfMap* perf_map)
+      LOCKS_EXCLUDED(dex_lock_);
+
   const std::vector<const DexFile*>& GetBootClassPath() {
     return boot_class_path_;
   }
@@ -831,6 +836,7 @@ class ClassLinker {
   friend class ElfPatcher;  // for FindOpenedOatFileForDexFile & FindOpenedOatFileFromOatLocation
   friend class NoDex2OatTest;  // for FindOpenedOatFileForDexFile
   friend class NoPatchoatTest;  // for FindOpenedOatFileForDexFile
+  friend class PerfMapTest;  // for FindOpenedOatDexFileForDexFile
   FRIEND_TEST(ClassLinkerTest, ClassRootDescriptors);
   FRIEND_TEST(mirror::DexCacheTest, Open);
   FRIEND_TEST(ExceptionTest, FindExceptionHandler);
@@ -830,6 +830,10 @@ bool Dbg::IsJdwpConfigured() {
   return gJdwpConfigured;
 }
 
+JDWP::JdwpState* Dbg::GetJdwpState() {
+  return gJdwpState;
+}
+
 int64_t Dbg::LastDebuggerActivity() {
   return gJdwpState->LastDebuggerActivity();
 }
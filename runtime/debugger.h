@@ -240,6 +240,9 @@ class Dbg {
 
   static bool IsDisposed();
 
+  // Returns the JDWP state, or null if JDWP is not running.
+  static JDWP::JdwpState* GetJdwpState();
+
   /*
    * Time, in milliseconds, since the last debugger activity.  Does not
    * include DDMS activity.  Returns -1 if there has been no activity.
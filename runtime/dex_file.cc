@@ -23,6 +23,7 @@
 #include <string.h>
 #include <sys/file.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <memory>
 
 #include "base/logging.h"
@@ -359,6 +360,7 @@ DexFile::DexFile(const byte* base, size_t size,
       class_defs_(reinterpret_cast<const ClassDef*>(base + header_->class_defs_off_)),
       find_class_def_misses_(0),
       class_def_index_(nullptr),
+      type_idx_to_class_def_idx_(nullptr),
       build_class_def_index_mutex_("DexFile index creation mutex"),
       oat_file_(oat_file) {
   CHECK(begin_ != NULL) << GetLocation();
@@ -370,8 +372,9 @@ DexFile::~DexFile() {
   // that's only called after DetachCurrentThread, which means there's no JNIEnv. We could
   // re-attach, but cleaning up these global references is not obviously useful. It's not as if
   // the global reference table is otherwise empty!
-  // Remove the index if one were created.
+  // Remove the indexes if they were created.
   delete class_def_index_.LoadRelaxed();
+  delete[] type_idx_to_class_def_idx_.LoadRelaxed();
 }
 
 bool DexFile::Init(std::string* error_msg) {
@@ -437,12 +440,9 @@ const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor, size_t ha
   if (string_id != nullptr) {
     const TypeId* type_id = FindTypeId(GetIndexForStringId(*string_id));
     if (type_id != nullptr) {
-      uint16_t type_idx = GetIndexForTypeId(*type_id);
-      for (size_t i = 0; i < num_class_defs; ++i) {
-        const ClassDef& class_def = GetClassDef(i);
-        if (class_def.class_idx_ == type_idx) {
-          return &class_def;
-        }
+      const ClassDef* class_def = FindClassDef(GetIndexForTypeId(*type_id));
+      if (class_def != nullptr) {
+        return class_def;
       }
     }
   }
@@ -468,7 +468,45 @@ const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor, size_t ha
   return nullptr;
 }
 
+const uint16_t* DexFile::GetTypeIdxToClassDefIdx() const {
+  uint16_t* index = type_idx_to_class_def_idx_.LoadSequentiallyConsistent();
+  if (LIKELY(index != nullptr)) {
+    return index;
+  }
+  // A linear search is as quick for a handful of classes. Class def indices must also leave
+  // kDexNoIndex16 free to mark types without a class def.
+  const uint32_t kMinClassDefsForTypeIndex = 16;
+  const uint32_t num_class_defs = NumClassDefs();
+  if (num_class_defs < kMinClassDefsForTypeIndex || num_class_defs >= kDexNoIndex16) {
+    return nullptr;
+  }
+  MutexLock mu(Thread::Current(), build_class_def_index_mutex_);
+  index = type_idx_to_class_def_idx_.LoadSequentiallyConsistent();
+  if (index == nullptr) {
+    const size_t num_type_ids = NumTypeIds();
+    index = new uint16_t[num_type_ids];
+    std::fill_n(index, num_type_ids, kDexNoIndex16);
+    // Iterate backwards so that the first class def wins for duplicated types, as it does in the
+    // linear search.
+    for (uint32_t i = num_class_defs; i != 0; --i) {
+      const uint16_t type_idx = GetClassDef(i - 1).class_idx_;
+      if (type_idx < num_type_ids) {
+        index[type_idx] = i - 1;
+      }
+    }
+    type_idx_to_class_def_idx_.StoreSequentiallyConsistent(index);
+  }
+  return index;
+}
+
 const DexFile::ClassDef* DexFile::FindClassDef(uint16_t type_idx) const {
+  const uint16_t* index = GetTypeIdxToClassDefIdx();
+  if (index != nullptr) {
+    if (type_idx >= NumTypeIds() || index[type_idx] == kDexNoIndex16) {
+      return nullptr;
+    }
+    return &GetClassDef(index[type_idx]);
+  }
   size_t num_class_defs = NumClassDefs();
   for (size_t i = 0; i < num_class_defs; ++i) {
     const ClassDef& class_def = GetClassDef(i);
@@ -479,6 +517,51 @@ const DexFile::ClassDef* DexFile::FindClassDef(uint16_t type_idx) const {
   return NULL;
 }
 
+bool DexFile::IsMethodAnnotationPresent(const ClassDef& class_def, uint32_t method_idx,
+                                        const char* annotation_descriptor) const {
+  const AnnotationsDirectoryItem* directory = GetAnnotationsDirectory(class_def);
+  if (directory == NULL || directory->methods_size_ == 0) {
+    return false;
+  }
+  // Method annotations follow the directory header and its field annotations.
+  const FieldAnnotationsItem* field_annotations =
+      reinterpret_cast<const FieldAnnotationsItem*>(directory + 1);
+  const MethodAnnotationsItem* method_annotations =
+      reinterpret_cast<const MethodAnnotationsItem*>(field_annotations + directory->fields_size_);
+  for (uint32_t i = 0; i < directory->methods_size_; ++i) {
+    if (method_annotations[i].method_idx_ != method_idx) {
+      continue;
+    }
+    const AnnotationSetItem* set =
+        reinterpret_cast<const AnnotationSetItem*>(begin_ + method_annotations[i].annotations_off_);
+    for (uint32_t j = 0; j < set->size_; ++j) {
+      const AnnotationItem* annotation =
+          reinterpret_cast<const AnnotationItem*>(begin_ + set->entries_[j]);
+      const byte* data = annotation->annotation_;
+      uint32_t type_idx = DecodeUnsignedLeb128(&data);
+      if (strcmp(StringByTypeIdx(type_idx), annotation_descriptor) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return false;
+}
+
+bool DexFile::IsCriticalNativeMethod(const ClassDef& class_def, uint32_t method_idx,
+                                     uint32_t access_flags) const {
+  const uint32_t kRequiredFlags = kAccNative | kAccStatic;
+  if ((access_flags & kRequiredFlags) != kRequiredFlags ||
+      (access_flags & (kAccSynchronized | kAccDeclaredSynchronized)) != 0) {
+    return false;
+  }
+  if (strchr(GetMethodShorty(GetMethodId(method_idx)), 'L') != NULL) {
+    return false;
+  }
+  return IsMethodAnnotationPresent(class_def, method_idx,
+                                   "Ldalvik/annotation/optimization/CriticalNative;");
+}
+
 const DexFile::FieldId* DexFile::FindFieldId(const DexFile::TypeId& declaring_klass,
                                               const DexFile::StringId& name,
                                               const DexFile::TypeId& type) const {
@@ -655,7 +655,8 @@ class DexFile {
   // ComputeModifiedUtf8Hash(descriptor).
   const ClassDef* FindClassDef(const char* descriptor, size_t hash) const;
 
-  // Looks up a class definition by its type index.
+  // Looks up a class definition by its type index. Constant time once the dex file has more
+  // than a few class defs.
   const ClassDef* FindClassDef(uint16_t type_idx) const;
 
   const TypeList* GetInterfacesList(const ClassDef& class_def) const {
@@ -676,6 +677,25 @@ class DexFile {
     }
   }
 
+  const AnnotationsDirectoryItem* GetAnnotationsDirectory(const ClassDef& class_def) const {
+    if (class_def.annotations_off_ == 0) {
+      return NULL;
+    } else {
+      return reinterpret_cast<const AnnotationsDirectoryItem*>(begin_ + class_def.annotations_off_);
+    }
+  }
+
+  // Returns true if the method is annotated with the annotation type of the given descriptor,
+  // regardless of the annotation's visibility.
+  bool IsMethodAnnotationPresent(const ClassDef& class_def, uint32_t method_idx,
+                                 const char* annotation_descriptor) const;
+
+  // Returns true if the method is a static, non-synchronized native whose shorty has no
+  // references and that is annotated @dalvik.annotation.optimization.CriticalNative. Such
+  // methods are called without a JNIEnv*, jclass or thread state transition.
+  bool IsCriticalNativeMethod(const ClassDef& class_def, uint32_t method_idx,
+                              uint32_t access_flags) const;
+
   //
   const CodeItem* GetCodeItem(const uint32_t code_off) const {
     if (code_off == 0) {
@@ -945,6 +965,10 @@ class DexFile {
   // Returns true if the header magic and version numbers are of the expected values.
   bool CheckMagicAndVersion(std::string* error_msg) const;
 
+  // Returns the index for FindClassDef(type_idx), building it if needed, or null if the class
+  // defs should be searched linearly.
+  const uint16_t* GetTypeIdxToClassDefIdx() const;
+
   void DecodeDebugInfo0(const CodeItem* code_item, bool is_static, uint32_t method_idx,
       DexDebugNewPositionCb position_cb, DexDebugNewLocalCb local_cb,
       void* context, const byte* stream, LocalInfo* local_in_reg) const;
@@ -1020,6 +1044,10 @@ class DexFile {
   };
   typedef HashMap<const char*, const ClassDef*, UTF16EmptyFn, UTF16HashCmp, UTF16HashCmp> Index;
   mutable Atomic<Index*> class_def_index_;
+
+  // Class def index for each type index, or kDexNoIndex16. Built on the first lookup by type
+  // index, and not at all for dex files with only a few class defs.
+  mutable Atomic<uint16_t*> type_idx_to_class_def_idx_;
   mutable Mutex build_class_def_index_mutex_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   // The oat file this dex file was loaded from. May be null in case the dex file is not coming
@@ -301,6 +301,27 @@ TEST_F(DexFileTest, FindTypeId) {
   }
 }
 
+TEST_F(DexFileTest, FindClassDefByTypeIdx) {
+  const DexFile* dex_file = java_lang_dex_file_;
+  std::vector<const DexFile::ClassDef*> expected(dex_file->NumTypeIds(), nullptr);
+  for (size_t i = 0; i < dex_file->NumClassDefs(); i++) {
+    const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
+    ASSERT_TRUE(expected[class_def.class_idx_] == nullptr);
+    expected[class_def.class_idx_] = &class_def;
+  }
+  for (size_t i = 0; i < dex_file->NumTypeIds(); i++) {
+    EXPECT_EQ(expected[i], dex_file->FindClassDef(static_cast<uint16_t>(i)))
+        << dex_file->StringByTypeIdx(i);
+    const char* descriptor = dex_file->StringByTypeIdx(i);
+    EXPECT_EQ(expected[i], dex_file->FindClassDef(descriptor, ComputeModifiedUtf8Hash(descriptor)))
+        << descriptor;
+  }
+  // Out of range type indices have no class def.
+  if (dex_file->NumTypeIds() < DexFile::kDexNoIndex16) {
+    EXPECT_TRUE(dex_file->FindClassDef(DexFile::kDexNoIndex16) == nullptr);
+  }
+}
+
 TEST_F(DexFileTest, FindProtoId) {
   for (size_t i = 0; i < java_lang_dex_file_->NumProtoIds(); i++) {
     const DexFile::ProtoId& to_find = java_lang_dex_file_->GetProtoId(i);
@@ -31,11 +31,16 @@ extern "C" void* artFindNativeMethod() {
 extern "C" void* artFindNativeMethod(Thread* self) {
   DCHECK_EQ(self, Thread::Current());
 #endif
-  Locks::mutator_lock_->AssertNotHeld(self);  // We come here as Native.
+  // We come here as Native, or still Runnable from the stub of a critical native.
+  const bool runnable = self->GetState() == kRunnable;
+  if (!runnable) {
+    Locks::mutator_lock_->AssertNotHeld(self);
+  }
   ScopedObjectAccess soa(self);
 
   mirror::ArtMethod* method = self->GetCurrentMethod(NULL);
   DCHECK(method != NULL);
+  DCHECK(!runnable || method->IsCriticalNative()) << PrettyMethod(method);
 
   // Lookup symbol address for method, on failure we'll return NULL with an exception set,
   // otherwise we return the address of the method we found.
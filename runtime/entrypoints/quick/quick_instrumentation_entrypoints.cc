@@ -33,7 +33,9 @@ extern "C" const void* artInstrumentationMethodEntryFromCode(mirror::ArtMethod*
   FinishCalleeSaveFrameSetup(self, sp, Runtime::kRefsAndArgs);
   instrumentation::Instrumentation* instrumentation = Runtime::Current()->GetInstrumentation();
   const void* result;
-  if (instrumentation->IsDeoptimized(method)) {
+  // Watched methods come here whatever else is installed, so also check for the interpreter.
+  if (instrumentation->IsDeoptimized(method) ||
+      (instrumentation->InterpretOnly() && !method->IsNative())) {
     result = GetQuickToInterpreterBridge();
   } else {
     result = instrumentation->GetQuickCodeFor(method, sizeof(void*));
@@ -1302,7 +1302,8 @@ class ComputeNativeCallFrameSize {
 
 class ComputeGenericJniFrameSize FINAL : public ComputeNativeCallFrameSize {
  public:
-  ComputeGenericJniFrameSize() : num_handle_scope_references_(0) {}
+  explicit ComputeGenericJniFrameSize(bool critical_native)
+      : num_handle_scope_references_(0), critical_native_(critical_native) {}
 
   // Lays out the callee-save frame. Assumes that the incorrect frame corresponding to RefsAndArgs
   // is at *m = sp. Will update to point to the bottom of the save frame.
@@ -1386,12 +1387,13 @@ class ComputeGenericJniFrameSize FINAL : public ComputeNativeCallFrameSize {
 
   uintptr_t PushHandle(mirror::Object* /* ptr */) OVERRIDE;
 
-  // Add JNIEnv* and jobj/jclass before the shorty-derived elements.
+  // Add JNIEnv* and jobj/jclass before the shorty-derived elements, unless critical.
   void WalkHeader(BuildNativeCallFrameStateMachine<ComputeNativeCallFrameSize>* sm) OVERRIDE
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
  private:
   uint32_t num_handle_scope_references_;
+  const bool critical_native_;
 };
 
 uintptr_t ComputeGenericJniFrameSize::PushHandle(mirror::Object* /* ptr */) {
@@ -1401,6 +1403,11 @@ uintptr_t ComputeGenericJniFrameSize::PushHandle(mirror::Object* /* ptr */) {
 
 void ComputeGenericJniFrameSize::WalkHeader(
     BuildNativeCallFrameStateMachine<ComputeNativeCallFrameSize>* sm) {
+  if (critical_native_) {
+    // Critical natives are passed the managed arguments only.
+    return;
+  }
+
   // JNIEnv
   sm->AdvancePointer(nullptr);
 
@@ -1460,10 +1467,11 @@ class FillNativeCall {
 class BuildGenericJniFrameVisitor FINAL : public QuickArgumentVisitor {
  public:
   BuildGenericJniFrameVisitor(StackReference<mirror::ArtMethod>** sp, bool is_static,
-                              const char* shorty, uint32_t shorty_len, Thread* self)
+                              bool critical_native, const char* shorty, uint32_t shorty_len,
+                              Thread* self)
      : QuickArgumentVisitor(*sp, is_static, shorty, shorty_len),
        jni_call_(nullptr, nullptr, nullptr, nullptr), sm_(&jni_call_) {
-    ComputeGenericJniFrameSize fsc;
+    ComputeGenericJniFrameSize fsc(critical_native);
     uintptr_t* start_gpr_reg;
     uint32_t* start_fpr_reg;
     uintptr_t* start_stack_arg;
@@ -1475,11 +1483,13 @@ class BuildGenericJniFrameVisitor FINAL : public QuickArgumentVisitor {
     handle_scope_->SetNumberOfReferences(handle_scope_entries);
     jni_call_.Reset(start_gpr_reg, start_fpr_reg, start_stack_arg, handle_scope_);
 
-    // jni environment is always first argument
-    sm_.AdvancePointer(self->GetJniEnv());
+    if (!critical_native) {
+      // jni environment is always first argument
+      sm_.AdvancePointer(self->GetJniEnv());
 
-    if (is_static) {
-      sm_.AdvanceHandleScope((*sp)->AsMirrorPtr()->GetDeclaringClass());
+      if (is_static) {
+        sm_.AdvanceHandleScope((*sp)->AsMirrorPtr()->GetDeclaringClass());
+      }
     }
   }
 
@@ -1522,7 +1532,8 @@ class BuildGenericJniFrameVisitor FINAL : public QuickArgumentVisitor {
       while (cur_entry_ < expected_slots) {
         handle_scope_->GetHandle(cur_entry_++).Assign(nullptr);
       }
-      DCHECK_NE(cur_entry_, 0U);
+      // Only critical natives get no jobject or jclass.
+      DCHECK(cur_entry_ != 0U || expected_slots == 0U);
     }
 
    private:
@@ -1644,7 +1655,9 @@ extern "C" TwoWordReturn artQuickGenericJniTrampoline(Thread* self,
   const char* shorty = called->GetShorty(&shorty_len);
 
   // Run the visitor.
-  BuildGenericJniFrameVisitor visitor(&sp, called->IsStatic(), shorty, shorty_len, self);
+  // Critical natives still transition to Native here; only compiled stubs skip that.
+  BuildGenericJniFrameVisitor visitor(&sp, called->IsStatic(), called->IsCriticalNative(), shorty,
+                                      shorty_len, self);
   visitor.VisitArguments();
   visitor.FinalizeHandleScope(self);
 
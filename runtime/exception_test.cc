@@ -217,6 +217,19 @@ TEST_F(ExceptionTest, StackTraceElement) {
 
   jobject internal = thread->CreateInternalStackTrace<false>(soa);
   ASSERT_TRUE(internal != NULL);
+  if (!kUsePortableCompiler) {
+    // Compiled frames are recorded by native pc, and only mapped to their dex pc when decoded.
+    mirror::ObjectArray<mirror::Object>* method_trace =
+        soa.Decode<mirror::ObjectArray<mirror::Object>*>(internal);
+    ASSERT_EQ(3, method_trace->GetLength());
+    mirror::IntArray* pc_trace = down_cast<mirror::IntArray*>(method_trace->Get(2));
+    for (int32_t i = 0; i < 2; ++i) {
+      mirror::ArtMethod* method = down_cast<mirror::ArtMethod*>(method_trace->Get(i));
+      uint32_t pc = static_cast<uint32_t>(pc_trace->Get(i));
+      EXPECT_NE(3u, pc);
+      EXPECT_EQ(3u, Thread::InternalStackTraceDexPc(method, pc));
+    }
+  }
   jobjectArray ste_array = Thread::InternalStackTraceToStackTraceElementArray(soa, internal);
   ASSERT_TRUE(ste_array != NULL);
   mirror::ObjectArray<mirror::StackTraceElement>* trace_array =
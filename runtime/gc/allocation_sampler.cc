@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <ostream>
+#include <sstream>
+
+#include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "os.h"
+#include "stack.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+// Deeper frames are dropped, like the allocation tracker does.
+static constexpr size_t kMaxSampleStackDepth = 64;
+
+class SampleStackVisitor : public StackVisitor {
+ public:
+  explicit SampleStackVisitor(Thread* thread) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr) {}
+
+  bool VisitFrame() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    if (frames_.size() == kMaxSampleStackDepth) {
+      return false;
+    }
+    mirror::ArtMethod* m = GetMethod();
+    if (!m->IsRuntimeMethod()) {
+      frames_.push_back(std::make_pair(m, GetDexPc()));
+    }
+    return true;
+  }
+
+  const std::vector<std::pair<mirror::ArtMethod*, uint32_t>>& GetFrames() const {
+    return frames_;
+  }
+
+ private:
+  std::vector<std::pair<mirror::ArtMethod*, uint32_t>> frames_;
+};
+
+AllocationSampler::AllocationSampler(size_t interval, const std::string& output_file)
+    : interval_(interval), lock_("allocation sampler lock"), output_file_(output_file),
+      distribution_(1.0 / interval), sample_count_(0) {
+  CHECK_NE(interval, 0U);
+  generator_.seed(NanoTime() * getpid());
+}
+
+void AllocationSampler::DidForkFromZygote() {
+  MutexLock mu(Thread::Current(), lock_);
+  if (!output_file_.empty()) {
+    StringAppendF(&output_file_, ".%d", getpid());
+  }
+  // Otherwise every process forked from the zygote would draw the same budgets.
+  generator_.seed(NanoTime() * getpid());
+  locations_.clear();
+  class_locations_.clear();
+  frame_locations_.clear();
+  samples_.clear();
+  sample_count_ = 0;
+}
+
+size_t AllocationSampler::NextBudget() {
+  // Never 0, which tells a thread that has no budget yet.
+  return static_cast<size_t>(distribution_(generator_)) + 1;
+}
+
+void AllocationSampler::SampleAllocation(Thread* self, mirror::Class* klass, size_t byte_count) {
+  if (UNLIKELY(self->GetAllocSampleBytesLeft() == 0)) {
+    MutexLock mu(self, lock_);
+    self->SetAllocSampleBytesLeft(NextBudget());
+    return;
+  }
+  // Walk the stack and name the class before taking the lock, neither needs it.
+  SampleStackVisitor visitor(self);
+  visitor.WalkStack();
+  std::string class_name(PrettyDescriptor(klass));
+  MutexLock mu(self, lock_);
+  self->SetAllocSampleBytesLeft(NextBudget());
+  std::vector<uint32_t> stack;
+  stack.reserve(visitor.GetFrames().size() + 1);
+  stack.push_back(ClassLocation(class_name));
+  for (const auto& frame : visitor.GetFrames()) {
+    stack.push_back(FrameLocation(frame.first, frame.second));
+  }
+  Counts& counts = samples_[stack];
+  ++counts.objects;
+  counts.bytes += byte_count;
+  ++sample_count_;
+}
+
+uint32_t AllocationSampler::ClassLocation(const std::string& class_name) {
+  auto it = class_locations_.find(class_name);
+  if (it != class_locations_.end()) {
+    return it->second;
+  }
+  locations_.push_back(class_name);
+  uint32_t location = locations_.size();
+  class_locations_.Put(class_name, location);
+  return location;
+}
+
+uint32_t AllocationSampler::FrameLocation(mirror::ArtMethod* method, uint32_t dex_pc) {
+  auto key = std::make_pair(method, dex_pc);
+  auto it = frame_locations_.find(key);
+  if (it != frame_locations_.end()) {
+    return it->second;
+  }
+  std::string name(PrettyMethod(method, false));
+  const char* source_file = method->GetDeclaringClassSourceFile();
+  if (source_file != nullptr) {
+    int32_t line = method->GetLineNumFromDexPC(dex_pc);
+    if (line >= 0) {
+      StringAppendF(&name, " (%s:%d)", source_file, line);
+    } else {
+      StringAppendF(&name, " (%s)", source_file);
+    }
+  }
+  locations_.push_back(name);
+  uint32_t location = locations_.size();
+  frame_locations_.Put(key, location);
+  return location;
+}
+
+void AllocationSampler::Dump(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  os << "--- heapz 1 ---\n"
+     << "format = java\n"
+     << "resolution = bytes\n"
+     << "sampling period = " << interval_ << "\n";
+  for (const auto& sample : samples_) {
+    os << sample.second.objects << " " << sample.second.bytes << " @";
+    for (uint32_t location : sample.first) {
+      os << StringPrintf(" 0x%x", location);
+    }
+    os << "\n";
+  }
+  for (size_t i = 0; i < locations_.size(); ++i) {
+    os << StringPrintf("0x%zx ", i + 1) << locations_[i] << "\n";
+  }
+}
+
+void AllocationSampler::WriteProfile() {
+  std::string output_file(GetOutputFile());
+  if (output_file.empty()) {
+    return;
+  }
+  std::ostringstream os;
+  Dump(os);
+  std::string profile(os.str());
+  std::unique_ptr<File> file(OS::CreateEmptyFile(output_file.c_str()));
+  if (file.get() == nullptr) {
+    PLOG(WARNING) << "Failed to create allocation profile " << output_file;
+    return;
+  }
+  if (!file->WriteFully(profile.data(), profile.size()) || file->FlushClose() != 0) {
+    PLOG(WARNING) << "Failed to write allocation profile " << output_file;
+  }
+}
+
+size_t AllocationSampler::GetSampleCount() {
+  MutexLock mu(Thread::Current(), lock_);
+  return sample_count_;
+}
+
+std::string AllocationSampler::GetOutputFile() {
+  MutexLock mu(Thread::Current(), lock_);
+  return output_file_;
+}
+
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <iosfwd>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "safe_map.h"
+
+namespace art {
+
+class Thread;
+
+namespace mirror {
+  class ArtMethod;
+  class Class;
+}  // namespace mirror
+
+namespace gc {
+
+// Records the class, size and stack of about one allocation per interval bytes allocated, for
+// finding allocation churn without tracking every allocation. Each thread counts down a random
+// byte budget, drawn from an exponential distribution with the interval as its mean, and only
+// the allocation that uses it up takes the slow path into SampleAllocation. Samples with the
+// same class and stack are merged. Enabled with -Xalloc-sample-file.
+class AllocationSampler {
+ public:
+  static constexpr size_t kDefaultInterval = 512 * 1024;
+
+  // The profile is written to output_file on SIGQUIT and at shutdown, unless it is empty.
+  AllocationSampler(size_t interval, const std::string& output_file);
+
+  // Called in a process forked from the zygote. Drops the samples inherited from the zygote and
+  // writes the profile of this process to "<output file>.<pid>" instead.
+  void DidForkFromZygote() LOCKS_EXCLUDED(lock_);
+
+  // Called when an allocation of byte_count bytes used up the budget of self. Records the
+  // allocation, unless this is the first allocation of self since sampling started, and gives
+  // self a new budget.
+  void SampleAllocation(Thread* self, mirror::Class* klass, size_t byte_count)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(lock_);
+
+  // Writes the samples in the Java heap profile text format read by pprof ("--- heapz 1 ---").
+  // Each sample line is "<objects> <bytes> @ <locations>", leaf first, with the allocated class
+  // as the leaf location. The locations are listed after the samples.
+  void Dump(std::ostream& os) LOCKS_EXCLUDED(lock_);
+
+  // Replaces the contents of the output file with Dump.
+  void WriteProfile() LOCKS_EXCLUDED(lock_);
+
+  size_t GetInterval() const {
+    return interval_;
+  }
+
+  size_t GetSampleCount() LOCKS_EXCLUDED(lock_);
+
+  std::string GetOutputFile() LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Counts {
+    Counts() : objects(0), bytes(0) {}
+    uint64_t objects;
+    uint64_t bytes;
+  };
+
+  size_t NextBudget() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  uint32_t ClassLocation(const std::string& class_name) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  uint32_t FrameLocation(mirror::ArtMethod* method, uint32_t dex_pc)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t interval_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::string output_file_ GUARDED_BY(lock_);
+  std::default_random_engine generator_ GUARDED_BY(lock_);
+  std::exponential_distribution<double> distribution_ GUARDED_BY(lock_);
+  // Names of the locations, a location is its index plus one.
+  std::vector<std::string> locations_ GUARDED_BY(lock_);
+  SafeMap<std::string, uint32_t> class_locations_ GUARDED_BY(lock_);
+  // Methods are not moved by the GC (see kMovingMethods) so they are used as keys directly.
+  SafeMap<std::pair<mirror::ArtMethod*, uint32_t>, uint32_t> frame_locations_
+      GUARDED_BY(lock_);
+  // Keyed by the locations of the class and the stack, leaf first.
+  std::map<std::vector<uint32_t>, Counts> samples_ GUARDED_BY(lock_);
+  size_t sample_count_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
@@ -64,6 +64,11 @@ static constexpr bool kParallelRecursiveMark = true;
 // ProcessMarkStack with very small mark stacks.
 static constexpr size_t kMinimumParallelMarkStackSize = 128;
 static constexpr bool kParallelProcessMarkStack = true;
+// Mark the roots of suspended threads on the GC thread pool during pauses once there are at least
+// this many threads. Each task visits up to kThreadRootsChunkSize threads.
+static constexpr bool kParallelThreadRoots = true;
+static constexpr size_t kMinimumParallelThreadRootsThreads = 16;
+static constexpr size_t kThreadRootsChunkSize = 4;
 
 // Profiling and information flags.
 static constexpr bool kProfileLargeObjects = false;
@@ -284,8 +289,8 @@ void MarkSweep::ReclaimPhase() {
   Thread* self = Thread::Current();
   // Process the references concurrently.
   ProcessReferences(self);
+  // Also allows new system weaks again.
   SweepSystemWeaks(self);
-  Runtime::Current()->AllowNewSystemWeaks();
   {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
     // Reclaim unmarked objects.
@@ -491,7 +496,13 @@ void MarkSweep::MarkRoots(Thread* self) {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   if (Locks::mutator_lock_->IsExclusiveHeld(self)) {
     // If we exclusively hold the mutator lock, all threads must be suspended.
-    Runtime::Current()->VisitRoots(MarkRootCallback, this);
+    if (kParallelThreadRoots && GetThreadCount(true) > 1) {
+      MarkThreadRootsParallel(self);
+      MarkNonThreadRoots();
+      MarkConcurrentRoots(kVisitRootFlagAllRoots);
+    } else {
+      Runtime::Current()->VisitRoots(MarkRootCallback, this);
+    }
     RevokeAllThreadLocalAllocationStacks(self);
   } else {
     MarkRootsCheckpoint(self, kRevokeRosAllocThreadLocalBuffersAtCheckpoint);
@@ -502,6 +513,53 @@ void MarkSweep::MarkRoots(Thread* self) {
   }
 }
 
+class MarkThreadRootsTask : public Task {
+ public:
+  MarkThreadRootsTask(MarkSweep* mark_sweep, std::vector<Thread*>::const_iterator begin,
+                      std::vector<Thread*>::const_iterator end)
+      : mark_sweep_(mark_sweep), begin_(begin), end_(end) {
+  }
+
+ protected:
+  MarkSweep* const mark_sweep_;
+  const std::vector<Thread*>::const_iterator begin_;
+  const std::vector<Thread*>::const_iterator end_;
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    for (auto it = begin_; it != end_; ++it) {
+      (*it)->VisitRoots(MarkSweep::MarkRootParallelCallback, mark_sweep_);
+    }
+  }
+};
+
+void MarkSweep::MarkThreadRootsParallel(Thread* self) {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  // Holding the thread list lock keeps threads from exiting while their roots are visited.
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  std::list<Thread*> thread_list = Runtime::Current()->GetThreadList()->GetList();
+  std::vector<Thread*> threads(thread_list.begin(), thread_list.end());
+  if (threads.size() < kMinimumParallelThreadRootsThreads) {
+    for (Thread* thread : threads) {
+      thread->VisitRoots(MarkRootCallback, this);
+    }
+    return;
+  }
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  for (auto it = threads.cbegin(), end = threads.cend(); it < end; ) {
+    const size_t delta = std::min(static_cast<size_t>(end - it), kThreadRootsChunkSize);
+    thread_pool->AddTask(self, new MarkThreadRootsTask(this, it, it + delta));
+    it += delta;
+  }
+  thread_pool->SetMaxActiveWorkers(GetThreadCount(true) - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+}
+
 void MarkSweep::MarkNonThreadRoots() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   Runtime::Current()->VisitNonThreadRoots(MarkRootCallback, this);
@@ -923,7 +981,7 @@ void MarkSweep::ReMarkRoots() {
 void MarkSweep::SweepSystemWeaks(Thread* self) {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
-  Runtime::Current()->SweepSystemWeaks(IsMarkedCallback, this);
+  Runtime::Current()->SweepAndAllowNewSystemWeaks(IsMarkedCallback, this);
 }
 
 mirror::Object* MarkSweep::VerifySystemWeakIsLiveCallback(Object* obj, void* arg) {
@@ -21,6 +21,7 @@
 
 #include "debugger.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/semi_space.h"
 #include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -151,6 +152,15 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self, mirror::Clas
     if (Dbg::IsAllocTrackingEnabled()) {
       Dbg::RecordAllocation(klass, bytes_allocated);
     }
+    if (UNLIKELY(allocation_sampler_.get() != nullptr)) {
+      size_t bytes_left = self->GetAllocSampleBytesLeft();
+      if (LIKELY(bytes_allocated < bytes_left)) {
+        self->SetAllocSampleBytesLeft(bytes_left - bytes_allocated);
+      } else {
+        // The class may have moved while pushing on the allocation stack.
+        allocation_sampler_->SampleAllocation(self, obj->GetClass(), bytes_allocated);
+      }
+    }
   } else {
     DCHECK(!Dbg::IsAllocTrackingEnabled());
   }
@@ -53,6 +53,7 @@
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "heap-inl.h"
 #include "image.h"
+#include "instrumentation.h"
 #include "intern_table.h"
 #include "mirror/art_field-inl.h"
 #include "mirror/class-inl.h"
@@ -885,6 +886,9 @@ Heap::~Heap() {
   STLDeleteElements(&discontinuous_spaces_);
   delete gc_complete_lock_;
   delete heap_trim_request_lock_;
+  if (allocation_sampler_.get() != nullptr) {
+    allocation_sampler_->WriteProfile();
+  }
   VLOG(heap) << "Finished ~Heap()";
 }
 
@@ -2868,6 +2872,18 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  if (allocation_sampler_.get() != nullptr) {
+    os << "Allocation samples: " << allocation_sampler_->GetSampleCount() << " (one per "
+       << PrettySize(allocation_sampler_->GetInterval()) << ")\n";
+    allocation_sampler_->WriteProfile();
+  }
+}
+
+void Heap::StartAllocationSampling(size_t interval, const std::string& output_file) {
+  CHECK(allocation_sampler_.get() == nullptr);
+  allocation_sampler_.reset(new AllocationSampler(interval, output_file));
+  // Only the instrumented allocation code samples.
+  Runtime::Current()->GetInstrumentation()->InstrumentQuickAllocEntryPoints();
 }
 
 size_t Heap::GetPercentFree() {
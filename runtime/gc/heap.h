@@ -56,6 +56,7 @@ namespace mirror {
 
 namespace gc {
 
+class AllocationSampler;
 class ReferenceProcessor;
 
 namespace accounting {
@@ -599,6 +600,16 @@ class Heap {
     return &reference_processor_;
   }
 
+  // Starts recording a sample of about one allocation per interval bytes, see AllocationSampler.
+  // Only called during startup, before other threads allocate; sampling is never stopped.
+  void StartAllocationSampling(size_t interval, const std::string& output_file)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
+  // The allocation sampler, or nullptr if allocations are not sampled.
+  AllocationSampler* GetAllocationSampler() {
+    return allocation_sampler_.get();
+  }
+
  private:
   // Compact source space to target space.
   void Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -1046,6 +1057,9 @@ class Heap {
   // Whether or not we use homogeneous space compaction to avoid OOM errors.
   bool use_homogeneous_space_compaction_for_oom_;
 
+  // Samples allocations made with instrumented allocation code, or nullptr.
+  std::unique_ptr<AllocationSampler> allocation_sampler_;
+
   friend class collector::GarbageCollector;
   friend class collector::MarkCompact;
   friend class collector::MarkSweep;
@@ -17,6 +17,7 @@
 #include "common_runtime_test.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/allocation_sampler.h"
 #include "handle_scope-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -71,5 +72,51 @@ TEST_F(HeapTest, HeapBitmapCapacityTest) {
   bitmap->Set(fake_end_of_heap_object);
 }
 
+TEST_F(HeapTest, AllocationSampling) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  EXPECT_TRUE(heap->GetAllocationSampler() == nullptr);
+  heap->StartAllocationSampling(4 * KB, "");
+  AllocationSampler* sampler = heap->GetAllocationSampler();
+  ASSERT_TRUE(sampler != nullptr);
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    for (size_t i = 0; i < 4096; ++i) {
+      mirror::String::AllocFromModifiedUtf8(soa.Self(), "hello, world!");
+    }
+  }
+  EXPECT_GT(sampler->GetSampleCount(), 0U);
+  std::ostringstream os;
+  sampler->Dump(os);
+  std::string profile(os.str());
+  EXPECT_EQ(0U, profile.find("--- heapz 1 ---\n")) << profile;
+  EXPECT_NE(std::string::npos, profile.find("sampling period = 4096\n")) << profile;
+  EXPECT_NE(std::string::npos, profile.find(" java.lang.String\n")) << profile;
+}
+
+TEST_F(HeapTest, AllocationSamplingAfterFork) {
+  // Nothing is written to the output file unless WriteProfile is called.
+  std::string output_file(android_data_ + "/allocations");
+  AllocationSampler sampler(4 * KB, output_file);
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* klass = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(klass != nullptr);
+  // The first call only gives the thread a budget.
+  for (size_t i = 0; i < 3; ++i) {
+    sampler.SampleAllocation(soa.Self(), klass, 16);
+  }
+  EXPECT_NE(0U, sampler.GetSampleCount());
+
+  sampler.DidForkFromZygote();
+  EXPECT_EQ(0U, sampler.GetSampleCount());
+  EXPECT_EQ(StringPrintf("%s.%d", output_file.c_str(), getpid()), sampler.GetOutputFile());
+  std::ostringstream os;
+  sampler.Dump(os);
+  EXPECT_EQ(std::string::npos, os.str().find(" @ ")) << os.str();
+  EXPECT_EQ(std::string::npos, os.str().find(" java.lang.Object\n")) << os.str();
+
+  sampler.SampleAllocation(soa.Self(), klass, 16);
+  EXPECT_EQ(1U, sampler.GetSampleCount());
+}
+
 }  // namespace gc
 }  // namespace art
@@ -15,16 +15,17 @@
  */
 
 /*
- * Preparation and completion of hprof data generation.  The output is
- * written into two files and then combined.  This is necessary because
- * we generate some of the data (strings and classes) while we dump the
- * heap, and some analysis tools require that the class and string data
- * appear first.
+ * Preparation and completion of hprof data generation.  Some of the data
+ * (strings and classes) is only discovered while we dump the heap, but
+ * analysis tools require that the class and string data appear first.
+ * Rather than buffering the whole heap dump in memory, we walk the heap
+ * twice: the first pass only measures the body and collects the strings
+ * and classes, the second pass streams the header and the body through
+ * a fixed-size buffer straight to the file or the DDMS socket.
  */
 
 #include "hprof.h"
 
-#include <cutils/open_memstream.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -32,10 +33,13 @@
 #include <sys/time.h>
 #include <sys/uio.h>
 #include <time.h>
-#include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
+#include <algorithm>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "base/logging.h"
 #include "base/stringprintf.h"
@@ -49,6 +53,8 @@
 #include "gc/heap.h"
 #include "gc/space/space.h"
 #include "globals.h"
+#include "jdwp/jdwp.h"
+#include "jdwp/jdwp_priv.h"
 #include "mirror/art_field-inl.h"
 #include "mirror/class.h"
 #include "mirror/class-inl.h"
@@ -57,6 +63,7 @@
 #include "safe_map.h"
 #include "scoped_thread_state_change.h"
 #include "thread_list.h"
+#include "utils.h"
 
 namespace art {
 
@@ -171,6 +178,210 @@ enum HprofBasicType {
 typedef uint32_t HprofStringId;
 typedef uint32_t HprofClassObjectId;
 
+// Sink for the serialized hprof stream. Errors are sticky: once a write fails, later writes are
+// dropped and HasError() reports the failure, so the dump code does not have to check every call.
+class HprofOutput {
+ public:
+  HprofOutput() : length_(0), error_(false) {}
+  virtual ~HprofOutput() {}
+
+  void Write(const void* data, size_t count) {
+    length_ += count;
+    if (!error_ && !HandleWrite(reinterpret_cast<const uint8_t*>(data), count)) {
+      error_ = true;
+    }
+  }
+
+  // Pushes all data written so far to the underlying sink. Must be called once after the last
+  // Write.
+  bool Finish() {
+    if (!error_ && !HandleFinish()) {
+      error_ = true;
+    }
+    return !error_;
+  }
+
+  // Total number of bytes written, including any that were dropped after an error.
+  size_t Length() const {
+    return length_;
+  }
+
+  bool HasError() const {
+    return error_;
+  }
+
+ protected:
+  virtual bool HandleWrite(const uint8_t* data, size_t count) = 0;
+  virtual bool HandleFinish() = 0;
+
+ private:
+  size_t length_;
+  bool error_;
+
+  DISALLOW_COPY_AND_ASSIGN(HprofOutput);
+};
+
+// Discards the data and only keeps track of its length. Used to size the dump up front.
+class CountingHprofOutput FINAL : public HprofOutput {
+ public:
+  CountingHprofOutput() {}
+
+ protected:
+  bool HandleWrite(const uint8_t* /* data */, size_t /* count */) OVERRIDE {
+    return true;
+  }
+
+  bool HandleFinish() OVERRIDE {
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CountingHprofOutput);
+};
+
+// Collects the data in a fixed-size buffer and hands it on in kBufferSize chunks, so the memory
+// needed for a dump does not depend on the size of the heap.
+class BufferedHprofOutput : public HprofOutput {
+ public:
+  static constexpr size_t kBufferSize = 64 * KB;
+
+  BufferedHprofOutput() : buffer_(new uint8_t[kBufferSize]), buffered_(0) {}
+
+ protected:
+  bool HandleWrite(const uint8_t* data, size_t count) OVERRIDE {
+    while (count != 0) {
+      if (buffered_ == kBufferSize && !FlushBuffer()) {
+        return false;
+      }
+      size_t chunk = std::min(count, kBufferSize - buffered_);
+      memcpy(buffer_.get() + buffered_, data, chunk);
+      buffered_ += chunk;
+      data += chunk;
+      count -= chunk;
+    }
+    return true;
+  }
+
+  bool HandleFinish() OVERRIDE {
+    return FlushBuffer();
+  }
+
+  // Writes out one chunk of buffered data.
+  virtual bool WriteBuffer(const uint8_t* data, size_t count) = 0;
+
+ private:
+  bool FlushBuffer() {
+    size_t count = buffered_;
+    buffered_ = 0;
+    return count == 0 || WriteBuffer(buffer_.get(), count);
+  }
+
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t buffered_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferedHprofOutput);
+};
+
+class FileHprofOutput FINAL : public BufferedHprofOutput {
+ public:
+  explicit FileHprofOutput(File* file) : file_(file) {}
+
+ protected:
+  bool WriteBuffer(const uint8_t* data, size_t count) OVERRIDE {
+    return file_->WriteFully(data, count);
+  }
+
+ private:
+  File* const file_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileHprofOutput);
+};
+
+// Writes a gzip stream. Heap dumps compress very well, mostly because of zeroed and repeated
+// primitive array data.
+class GzipHprofOutput FINAL : public BufferedHprofOutput {
+ public:
+  explicit GzipHprofOutput(File* file)
+      : file_(file), deflate_buffer_(new uint8_t[kBufferSize]), initialized_(false) {
+    memset(&stream_, 0, sizeof(stream_));
+    // A window size of 15 + 16 asks zlib for a gzip header and trailer instead of a zlib one.
+    initialized_ = deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                                Z_DEFAULT_STRATEGY) == Z_OK;
+  }
+
+  ~GzipHprofOutput() {
+    if (initialized_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+ protected:
+  bool WriteBuffer(const uint8_t* data, size_t count) OVERRIDE {
+    return Deflate(data, count, Z_NO_FLUSH);
+  }
+
+  bool HandleFinish() OVERRIDE {
+    return BufferedHprofOutput::HandleFinish() && Deflate(nullptr, 0, Z_FINISH);
+  }
+
+ private:
+  bool Deflate(const uint8_t* data, size_t count, int flush) {
+    if (!initialized_) {
+      return false;
+    }
+    stream_.next_in = const_cast<Bytef*>(data);
+    stream_.avail_in = count;
+    int rc;
+    do {
+      stream_.next_out = deflate_buffer_.get();
+      stream_.avail_out = kBufferSize;
+      rc = deflate(&stream_, flush);
+      if (rc == Z_STREAM_ERROR) {
+        return false;
+      }
+      size_t produced = kBufferSize - stream_.avail_out;
+      if (produced != 0 && !file_->WriteFully(deflate_buffer_.get(), produced)) {
+        return false;
+      }
+    } while (flush == Z_FINISH ? rc != Z_STREAM_END : stream_.avail_out == 0);
+    return true;
+  }
+
+  File* const file_;
+  std::unique_ptr<uint8_t[]> deflate_buffer_;
+  z_stream stream_;
+  bool initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(GzipHprofOutput);
+};
+
+// Writes straight to the debugger socket. The caller holds the socket lock for the whole dump so
+// that no other JDWP packet can end up in the middle of the chunk.
+class NetStateHprofOutput FINAL : public BufferedHprofOutput {
+ public:
+  explicit NetStateHprofOutput(JDWP::JdwpNetStateBase* net_state) : net_state_(net_state) {}
+
+ protected:
+  bool WriteBuffer(const uint8_t* data, size_t count) OVERRIDE {
+    std::vector<iovec> iov;
+    iov.push_back(iovec());
+    iov[0].iov_base = const_cast<uint8_t*>(data);
+    iov[0].iov_len = count;
+    errno = 0;
+    ssize_t actual = net_state_->WriteBufferedPacketLocked(iov);
+    if (static_cast<size_t>(actual) != count) {
+      PLOG(ERROR) << "Failed to send hprof data to debugger (" << actual << " of " << count << ")";
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  JDWP::JdwpNetStateBase* const net_state_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetStateHprofOutput);
+};
+
 // Represents a top-level hprof record, whose serialized format is:
 // U1  TAG: denoting the type of the record
 // U4  TIME: number of microseconds since the time stamp in the header
@@ -178,7 +389,9 @@ typedef uint32_t HprofClassObjectId;
 // U1* BODY: as many bytes as specified in the above uint32_t field
 class HprofRecord {
  public:
-  HprofRecord() : alloc_length_(128), fp_(nullptr), tag_(0), time_(0), length_(0), dirty_(false) {
+  HprofRecord()
+      : alloc_length_(kInitialAllocLength), out_(nullptr), tag_(0), time_(0), length_(0),
+        dirty_(false) {
     body_ = reinterpret_cast<unsigned char*>(malloc(alloc_length_));
   }
 
@@ -186,13 +399,13 @@ class HprofRecord {
     free(body_);
   }
 
-  int StartNewRecord(FILE* fp, uint8_t tag, uint32_t time) {
+  int StartNewRecord(HprofOutput* out, uint8_t tag, uint32_t time) {
     int rc = Flush();
     if (rc != 0) {
       return rc;
     }
 
-    fp_ = fp;
+    out_ = out;
     tag_ = tag;
     time_ = time;
     length_ = 0;
@@ -208,18 +421,24 @@ class HprofRecord {
       U4_TO_BUF_BE(headBuf, 1, time_);
       U4_TO_BUF_BE(headBuf, 5, length_);
 
-      int nb = fwrite(headBuf, 1, sizeof(headBuf), fp_);
-      if (nb != sizeof(headBuf)) {
-        return UNIQUE_ERROR;
-      }
-      nb = fwrite(body_, 1, length_, fp_);
-      if (nb != static_cast<int>(length_)) {
+      out_->Write(headBuf, sizeof(headBuf));
+      out_->Write(body_, length_);
+      if (out_->HasError()) {
         return UNIQUE_ERROR;
       }
 
       dirty_ = false;
     }
-    // TODO if we used less than half (or whatever) of allocLen, shrink the buffer.
+    // A single large array can grow the buffer a lot; don't hold on to that memory for the
+    // rest of the dump.
+    if (alloc_length_ > kMaxRetainedAllocLength) {
+      unsigned char* newBody = reinterpret_cast<unsigned char*>(realloc(body_,
+                                                                        kInitialAllocLength));
+      if (newBody != NULL) {
+        body_ = newBody;
+        alloc_length_ = kInitialAllocLength;
+      }
+    }
     return 0;
   }
 
@@ -348,6 +567,10 @@ class HprofRecord {
   }
 
  private:
+  static constexpr size_t kInitialAllocLength = 128;
+  // Large enough for the usual heap dump segment, see BYTES_PER_SEGMENT.
+  static constexpr size_t kMaxRetainedAllocLength = 64 * KB;
+
   int GuaranteeRecordAppend(size_t nmore) {
     size_t minSize = length_ + nmore;
     if (minSize > alloc_length_) {
@@ -372,7 +595,7 @@ class HprofRecord {
   size_t alloc_length_;
   unsigned char* body_;
 
-  FILE* fp_;
+  HprofOutput* out_;
   uint8_t tag_;
   uint32_t time_;
   size_t length_;
@@ -393,115 +616,174 @@ class Hprof {
         gc_scan_state_(0),
         current_heap_(HPROF_HEAP_DEFAULT),
         objects_in_segment_(0),
-        header_fp_(NULL),
-        header_data_ptr_(NULL),
-        header_data_size_(0),
-        body_fp_(NULL),
-        body_data_ptr_(NULL),
-        body_data_size_(0),
+        body_output_(nullptr),
+        header_length_(0),
+        body_length_(0),
+        length_mismatch_(false),
         next_string_id_(0x400000) {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
-
-    header_fp_ = open_memstream(&header_data_ptr_, &header_data_size_);
-    if (header_fp_ == NULL) {
-      PLOG(FATAL) << "header open_memstream failed";
-    }
-
-    body_fp_ = open_memstream(&body_data_ptr_, &body_data_size_);
-    if (body_fp_ == NULL) {
-      PLOG(FATAL) << "body open_memstream failed";
-    }
-  }
-
-  ~Hprof() {
-    if (header_fp_ != NULL) {
-      fclose(header_fp_);
-    }
-    if (body_fp_ != NULL) {
-      fclose(body_fp_);
-    }
-    free(header_data_ptr_);
-    free(body_data_ptr_);
   }
 
   void Dump()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
       LOCKS_EXCLUDED(Locks::heap_bitmap_lock_) {
-    // Walk the roots and the heap.
-    current_record_.StartNewRecord(body_fp_, HPROF_TAG_HEAP_DUMP_SEGMENT, HPROF_TIME);
+    // The roots are collected once up front: visiting them takes locks that may not be acquired
+    // while we hold the debugger socket lock below.
     Runtime::Current()->VisitRoots(RootVisitor, this);
+
     Thread* self = Thread::Current();
+    ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    // First pass: measure the body and collect the strings and classes it refers to. Nothing is
+    // retained apart from the string and class tables.
     {
-      ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
-      Runtime::Current()->GetHeap()->VisitObjects(VisitObjectCallback, this);
+      CountingHprofOutput counting_output;
+      ProcessBody(&counting_output);
+      body_length_ = counting_output.Length();
     }
-    current_record_.StartNewRecord(body_fp_, HPROF_TAG_HEAP_DUMP_END, HPROF_TIME);
-    current_record_.Flush();
-    fflush(body_fp_);
-
-    // Write the header.
-    WriteFixedHeader();
-    // Write the string and class tables, and any stack traces, to the header.
-    // (jhat requires that these appear before any of the data in the body that refers to them.)
-    WriteStringTable();
-    WriteClassTable();
-    WriteStackTraces();
-    current_record_.Flush();
-    fflush(header_fp_);
-
-    bool okay = true;
-    if (direct_to_ddms_) {
-      // Send the data off to DDMS.
-      iovec iov[2];
-      iov[0].iov_base = header_data_ptr_;
-      iov[0].iov_len = header_data_size_;
-      iov[1].iov_base = body_data_ptr_;
-      iov[1].iov_len = body_data_size_;
-      Dbg::DdmSendChunkV(CHUNK_TYPE("HPDS"), iov, 2);
-    } else {
-      // Where exactly are we writing to?
-      int out_fd;
-      if (fd_ >= 0) {
-        out_fd = dup(fd_);
-        if (out_fd < 0) {
-          ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
-          return;
-        }
-      } else {
-        out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
-        if (out_fd < 0) {
-          ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
-                                strerror(errno));
-          return;
-        }
-      }
-
-      std::unique_ptr<File> file(new File(out_fd, filename_, true));
-      okay = file->WriteFully(header_data_ptr_, header_data_size_) &&
-             file->WriteFully(body_data_ptr_, body_data_size_);
-      if (okay) {
-        okay = file->FlushCloseOrErase() == 0;
-      } else {
-        file->Erase();
-      }
-      if (!okay) {
-        std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
-                                     filename_.c_str(), strerror(errno)));
-        ThrowRuntimeException("%s", msg.c_str());
-        LOG(ERROR) << msg;
-      }
+    {
+      CountingHprofOutput counting_output;
+      ProcessHeader(&counting_output);
+      header_length_ = counting_output.Length();
     }
 
+    // Second pass: stream the header and the body to the destination.
+    bool okay = direct_to_ddms_ ? DumpToDdmsDirect() : DumpToFile();
+
     // Throw out a log message for the benefit of "runhat".
     if (okay) {
       uint64_t duration = NanoTime() - start_ns_;
       LOG(INFO) << "hprof: heap dump completed ("
-          << PrettySize(header_data_size_ + body_data_size_ + 1023)
+          << PrettySize(header_length_ + body_length_ + 1023)
           << ") in " << PrettyDuration(duration);
     }
   }
 
  private:
+  struct RootEntry {
+    const mirror::Object* obj;
+    HprofHeapTag tag;
+    uint32_t thread_serial_number;
+  };
+
+  bool DumpToDdmsDirect()
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+    JDWP::JdwpState* state = Dbg::GetJdwpState();
+    if (state == nullptr || !state->IsConnected()) {
+      VLOG(jdwp) << "Not sending heap dump: no debugger attached!";
+      return false;
+    }
+    JDWP::JdwpNetStateBase* net_state = state->netState;
+    Thread* self = Thread::Current();
+    MutexLock mu(self, *net_state->GetSocketLock());
+
+    // Form the JDWP plus DDMS header of the HPDS chunk, as in JdwpState::DdmSendChunkV; the dump
+    // follows it directly on the socket.
+    uint8_t header[kJDWPHeaderLen + 8];
+    size_t data_length = header_length_ + body_length_;
+    U4_TO_BUF_BE(header, 0, sizeof(header) + data_length);
+    U4_TO_BUF_BE(header, 4, state->NextRequestSerial());
+    header[8] = 0;  // flags
+    header[9] = kJDWPDdmCmdSet;
+    header[10] = kJDWPDdmCmd;
+    U4_TO_BUF_BE(header, 11, CHUNK_TYPE("HPDS"));
+    U4_TO_BUF_BE(header, 15, data_length);
+
+    NetStateHprofOutput output(net_state);
+    output.Write(header, sizeof(header));
+    return WriteHeaderAndBody(&output);
+  }
+
+  bool DumpToFile() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+    // Where exactly are we writing to?
+    int out_fd;
+    if (fd_ >= 0) {
+      out_fd = dup(fd_);
+      if (out_fd < 0) {
+        ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
+        return false;
+      }
+    } else {
+      out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+      if (out_fd < 0) {
+        ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
+                              strerror(errno));
+        return false;
+      }
+    }
+
+    std::unique_ptr<File> file(new File(out_fd, filename_, true));
+    bool okay;
+    if (EndsWith(filename_, ".gz")) {
+      GzipHprofOutput output(file.get());
+      okay = WriteHeaderAndBody(&output);
+    } else {
+      FileHprofOutput output(file.get());
+      okay = WriteHeaderAndBody(&output);
+    }
+    if (okay) {
+      okay = file->FlushCloseOrErase() == 0;
+    } else {
+      file->Erase();
+    }
+    if (!okay) {
+      std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
+                                   filename_.c_str(),
+                                   length_mismatch_ ? "the heap changed while it was dumped"
+                                                    : strerror(errno)));
+      ThrowRuntimeException("%s", msg.c_str());
+      LOG(ERROR) << msg;
+    }
+    return okay;
+  }
+
+  bool WriteHeaderAndBody(HprofOutput* output)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+    size_t start = output->Length();
+    ProcessHeader(output);
+    ProcessBody(output);
+    // The heap is suspended, so the second walk must reproduce the first one byte for byte.
+    // Otherwise the string table or the DDMS chunk length we already sent are wrong, and the dump
+    // is given up on rather than the process.
+    size_t written = output->Length() - start;
+    if (written != header_length_ + body_length_) {
+      LOG(ERROR) << "hprof: wrote " << written << " bytes, expected "
+                 << (header_length_ + body_length_);
+      length_mismatch_ = true;
+      return false;
+    }
+    return output->Finish();
+  }
+
+  // Writes the header. jhat requires that the string and class tables, and any stack traces,
+  // appear before any of the data in the body that refers to them.
+  void ProcessHeader(HprofOutput* output) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    WriteFixedHeader(output);
+    WriteStringTable(output);
+    WriteClassTable(output);
+    WriteStackTraces(output);
+    current_record_.Flush();
+  }
+
+  // Writes the heap dump records: the roots collected in Dump, followed by every live object.
+  void ProcessBody(HprofOutput* output)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+    body_output_ = output;
+    objects_in_segment_ = 0;
+    current_heap_ = HPROF_HEAP_DEFAULT;
+    current_record_.StartNewRecord(output, HPROF_TAG_HEAP_DUMP_SEGMENT, HPROF_TIME);
+    for (const RootEntry& root : roots_) {
+      gc_scan_state_ = root.tag;
+      gc_thread_serial_number_ = root.thread_serial_number;
+      MarkRootObject(root.obj, 0);
+    }
+    gc_scan_state_ = 0;
+    gc_thread_serial_number_ = 0;
+    Runtime::Current()->GetHeap()->VisitObjects(VisitObjectCallback, this);
+    current_record_.StartNewRecord(output, HPROF_TAG_HEAP_DUMP_END, HPROF_TIME);
+    current_record_.Flush();
+    body_output_ = nullptr;
+  }
+
   static void RootVisitor(mirror::Object** obj, void* arg, const RootInfo& root_info)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     DCHECK(arg != nullptr);
@@ -522,17 +804,14 @@ class Hprof {
 
   int DumpHeapObject(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
-  void Finish() {
-  }
-
-  int WriteClassTable() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  int WriteClassTable(HprofOutput* output) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     HprofRecord* rec = &current_record_;
     uint32_t nextSerialNumber = 1;
 
     for (mirror::Class* c : classes_) {
       CHECK(c != nullptr);
 
-      int err = current_record_.StartNewRecord(header_fp_, HPROF_TAG_LOAD_CLASS, HPROF_TIME);
+      int err = current_record_.StartNewRecord(output, HPROF_TAG_LOAD_CLASS, HPROF_TIME);
       if (UNLIKELY(err != 0)) {
         return err;
       }
@@ -551,14 +830,14 @@ class Hprof {
     return 0;
   }
 
-  int WriteStringTable() {
+  int WriteStringTable(HprofOutput* output) {
     HprofRecord* rec = &current_record_;
 
     for (std::pair<std::string, HprofStringId> p : strings_) {
       const std::string& string = p.first;
       size_t id = p.second;
 
-      int err = current_record_.StartNewRecord(header_fp_, HPROF_TAG_STRING, HPROF_TIME);
+      int err = current_record_.StartNewRecord(output, HPROF_TAG_STRING, HPROF_TIME);
       if (err != 0) {
         return err;
       }
@@ -582,7 +861,7 @@ class Hprof {
 
   void StartNewHeapDumpSegment() {
     // This flushes the old segment and starts a new one.
-    current_record_.StartNewRecord(body_fp_, HPROF_TAG_HEAP_DUMP_SEGMENT, HPROF_TIME);
+    current_record_.StartNewRecord(body_output_, HPROF_TAG_HEAP_DUMP_SEGMENT, HPROF_TIME);
     objects_in_segment_ = 0;
 
     // Starting a new HEAP_DUMP resets the heap to default.
@@ -632,13 +911,13 @@ class Hprof {
     return LookupStringId(PrettyDescriptor(c));
   }
 
-  void WriteFixedHeader() {
+  void WriteFixedHeader(HprofOutput* output) {
     char magic[] = "JAVA PROFILE 1.0.3";
     unsigned char buf[4];
 
     // Write the file header.
     // U1: NUL-terminated magic string.
-    fwrite(magic, 1, sizeof(magic), header_fp_);
+    output->Write(magic, sizeof(magic));
 
     // U4: size of identifiers.  We're using addresses as IDs and our heap references are stored
     // as uint32_t.
@@ -646,7 +925,7 @@ class Hprof {
     COMPILE_ASSERT(sizeof(mirror::HeapReference<mirror::Object>) == sizeof(uint32_t),
       UnexpectedHeapReferenceSize);
     U4_TO_BUF_BE(buf, 0, sizeof(uint32_t));
-    fwrite(buf, 1, sizeof(uint32_t), header_fp_);
+    output->Write(buf, sizeof(uint32_t));
 
     // The current time, in milliseconds since 0:00 GMT, 1/1/70.
     timeval now;
@@ -659,16 +938,16 @@ class Hprof {
 
     // U4: high word of the 64-bit time.
     U4_TO_BUF_BE(buf, 0, (uint32_t)(nowMs >> 32));
-    fwrite(buf, 1, sizeof(uint32_t), header_fp_);
+    output->Write(buf, sizeof(uint32_t));
 
     // U4: low word of the 64-bit time.
     U4_TO_BUF_BE(buf, 0, (uint32_t)(nowMs & 0xffffffffULL));
-    fwrite(buf, 1, sizeof(uint32_t), header_fp_);  // xxx fix the time
+    output->Write(buf, sizeof(uint32_t));
   }
 
-  void WriteStackTraces() {
+  void WriteStackTraces(HprofOutput* output) {
     // Write a dummy stack trace record so the analysis tools don't freak out.
-    current_record_.StartNewRecord(header_fp_, HPROF_TAG_STACK_TRACE, HPROF_TIME);
+    current_record_.StartNewRecord(output, HPROF_TAG_STACK_TRACE, HPROF_TIME);
     current_record_.AddU4(HPROF_NULL_STACK_TRACE);
     current_record_.AddU4(HPROF_NULL_THREAD);
     current_record_.AddU4(0);    // no frames
@@ -690,13 +969,16 @@ class Hprof {
   HprofHeapId current_heap_;  // Which heap we're currently dumping.
   size_t objects_in_segment_;
 
-  FILE* header_fp_;
-  char* header_data_ptr_;
-  size_t header_data_size_;
+  // Where heap dump segments go while ProcessBody is running.
+  HprofOutput* body_output_;
+
+  // Sizes measured by the first pass.
+  size_t header_length_;
+  size_t body_length_;
+  // Set if the second pass did not write what the first one measured.
+  bool length_mismatch_;
 
-  FILE* body_fp_;
-  char* body_data_ptr_;
-  size_t body_data_size_;
+  std::vector<RootEntry> roots_;
 
   std::set<mirror::Class*> classes_;
   HprofStringId next_string_id_;
@@ -1084,17 +1366,18 @@ void Hprof::VisitRoot(const mirror::Object* obj, const RootInfo& root_info) {
   if (obj == NULL) {
     return;
   }
-  gc_scan_state_ = xlate[root_info.GetType()];
-  gc_thread_serial_number_ = root_info.GetThreadId();
-  MarkRootObject(obj, 0);
-  gc_scan_state_ = 0;
-  gc_thread_serial_number_ = 0;
+  RootEntry entry;
+  entry.obj = obj;
+  entry.tag = xlate[root_info.GetType()];
+  entry.thread_serial_number = root_info.GetThreadId();
+  roots_.push_back(entry);
 }
 
 // If "direct_to_ddms" is true, the other arguments are ignored, and data is
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
+// If "filename" ends in ".gz", the output is gzip-compressed.
 void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
   CHECK(filename != NULL);
 
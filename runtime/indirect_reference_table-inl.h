@@ -46,7 +46,7 @@ inline bool IndirectReferenceTable::GetChecked(IndirectRef iref) const {
     AbortIfNoCheckJNI();
     return false;
   }
-  if (UNLIKELY(table_[idx].GetReference()->IsNull())) {
+  if (UNLIKELY(table_.LoadAcquire()[idx].GetReference()->IsNull())) {
     LOG(ERROR) << "JNI ERROR (app bug): accessed deleted " << kind_ << " " << iref;
     AbortIfNoCheckJNI();
     return false;
@@ -76,10 +76,11 @@ inline mirror::Object* IndirectReferenceTable::Get(IndirectRef iref) const {
     return kInvalidIndirectRefObject;
   }
   uint32_t idx = ExtractIndex(iref);
-  mirror::Object* obj = table_[idx].GetReference()->Read<kWithoutReadBarrier>();
+  IrtEntry* const table = table_.LoadAcquire();
+  mirror::Object* obj = table[idx].GetReference()->Read<kWithoutReadBarrier>();
   if (LIKELY(obj != kClearedJniWeakGlobal)) {
     // The read barrier or VerifyObject won't handle kClearedJniWeakGlobal.
-    obj = table_[idx].GetReference()->Read();
+    obj = table[idx].GetReference()->Read();
     VerifyObject(obj);
   }
   return obj;
@@ -24,6 +24,7 @@
 #include "utils.h"
 #include "verify_object-inl.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 namespace art {
@@ -54,6 +55,9 @@ std::ostream& operator<<(std::ostream& os, const MutatorLockedDumpable<T>& rhs)
   return os;
 }
 
+// Number of stale entries the hole stack may hold before it is rebuilt.
+static constexpr size_t kMinStaleHoles = 64;
+
 void IndirectReferenceTable::AbortIfNoCheckJNI() {
   // If -Xcheck:jni is on, it'll give a more detailed error before aborting.
   if (!Runtime::Current()->GetJavaVM()->check_jni) {
@@ -64,26 +68,77 @@ void IndirectReferenceTable::AbortIfNoCheckJNI() {
 
 IndirectReferenceTable::IndirectReferenceTable(size_t initialCount,
                                                size_t maxCount, IndirectRefKind desiredKind)
-    : kind_(desiredKind),
+    : table_(nullptr),
+      kind_(desiredKind),
+      alloc_entries_(0),
       max_entries_(maxCount) {
   CHECK_GT(initialCount, 0U);
   CHECK_LE(initialCount, maxCount);
+  CHECK_LT(maxCount, 65536U);
   CHECK_NE(desiredKind, kHandleScopeOrInvalid);
 
   std::string error_str;
-  const size_t table_bytes = maxCount * sizeof(IrtEntry);
-  table_mem_map_.reset(MemMap::MapAnonymous("indirect ref table", nullptr, table_bytes,
-                                            PROT_READ | PROT_WRITE, false, &error_str));
-  CHECK(table_mem_map_.get() != nullptr) << error_str;
-  CHECK_EQ(table_mem_map_->Size(), table_bytes);
-  table_ = reinterpret_cast<IrtEntry*>(table_mem_map_->Begin());
-  CHECK(table_ != nullptr);
+  CHECK(Resize(initialCount, &error_str)) << error_str;
   segment_state_.all = IRT_FIRST_SEGMENT;
 }
 
 IndirectReferenceTable::~IndirectReferenceTable() {
 }
 
+bool IndirectReferenceTable::Resize(size_t new_count, std::string* error_msg) {
+  DCHECK_GT(new_count, alloc_entries_);
+  DCHECK_LE(new_count, max_entries_);
+  const size_t table_bytes = new_count * sizeof(IrtEntry);
+  std::unique_ptr<MemMap> new_map(MemMap::MapAnonymous("indirect ref table", nullptr, table_bytes,
+                                                       PROT_READ | PROT_WRITE, false, error_msg));
+  if (new_map.get() == nullptr) {
+    return false;
+  }
+  CHECK_EQ(new_map->Size(), table_bytes);
+  IrtEntry* const old_table = table_.LoadRelaxed();
+  if (old_table != nullptr) {
+    // Only entries below the top can be in use.
+    memcpy(new_map->Begin(), old_table, segment_state_.parts.topIndex * sizeof(IrtEntry));
+  }
+  // Global references are decoded without a lock, see SynchronizedGet. The release store makes
+  // the copied entries visible to a reader that sees the new table.
+  table_.StoreRelease(reinterpret_cast<IrtEntry*>(new_map->Begin()));
+  // Use the rest of the last page too.
+  alloc_entries_ = std::min(new_map->BaseSize() / sizeof(IrtEntry), max_entries_);
+  if (table_mem_map_.get() != nullptr && kind_ != kLocal) {
+    // A reader that loaded the old table before the store above may still be using it.
+    old_table_mem_maps_.push_back(std::move(table_mem_map_));
+  }
+  table_mem_map_ = std::move(new_map);
+  return true;
+}
+
+size_t IndirectReferenceTable::TakeHole(size_t bottom_index, size_t top_index) {
+  while (!holes_.empty()) {
+    const size_t index = holes_.back();
+    holes_.pop_back();
+    // The entry may since have been filled, or eaten by a removal of the top-most entry, or
+    // belong to a segment that was popped.
+    if (index < top_index && table_.LoadRelaxed()[index].GetReference()->IsNull()) {
+      DCHECK_GE(index, bottom_index);
+      return index;
+    }
+  }
+  LOG(FATAL) << "No hole in " << kind_ << " table segment " << bottom_index << "-" << top_index;
+  return 0;
+}
+
+void IndirectReferenceTable::CompactHoles() {
+  holes_.clear();
+  const size_t top_index = segment_state_.parts.topIndex;
+  IrtEntry* const table = table_.LoadRelaxed();
+  for (size_t i = 0; i < top_index; ++i) {
+    if (table[i].GetReference()->IsNull()) {
+      holes_.push_back(i);
+    }
+  }
+}
+
 IndirectRef IndirectReferenceTable::Add(uint32_t cookie, mirror::Object* obj) {
   IRTSegmentState prevState;
   prevState.all = cookie;
@@ -91,39 +146,36 @@ IndirectRef IndirectReferenceTable::Add(uint32_t cookie, mirror::Object* obj) {
 
   CHECK(obj != NULL);
   VerifyObject(obj);
-  DCHECK(table_ != NULL);
+  DCHECK(table_.LoadRelaxed() != NULL);
   DCHECK_GE(segment_state_.parts.numHoles, prevState.parts.numHoles);
 
-  if (topIndex == max_entries_) {
-    LOG(FATAL) << "JNI ERROR (app bug): " << kind_ << " table overflow "
-               << "(max=" << max_entries_ << ")\n"
-               << MutatorLockedDumpable<IndirectReferenceTable>(*this);
-  }
-
-  // We know there's enough room in the table.  Now we just need to find
-  // the right spot.  If there's a hole, find it and fill it; otherwise,
-  // add to the end of the list.
+  // If there's a hole in the current segment, fill the most recent one;
+  // otherwise, add to the end of the list, expanding the table if needed.
   IndirectRef result;
   int numHoles = segment_state_.parts.numHoles - prevState.parts.numHoles;
   size_t index;
   if (numHoles > 0) {
     DCHECK_GT(topIndex, 1U);
-    // Find the first hole; likely to be near the end of the list.
-    IrtEntry* pScan = &table_[topIndex - 1];
-    DCHECK(!pScan->GetReference()->IsNull());
-    --pScan;
-    while (!pScan->GetReference()->IsNull()) {
-      DCHECK_GE(pScan, table_ + prevState.parts.topIndex);
-      --pScan;
-    }
-    index = pScan - table_;
+    index = TakeHole(prevState.parts.topIndex, topIndex);
     segment_state_.parts.numHoles--;
   } else {
-    // Add to the end.
+    if (segment_state_.parts.numHoles == 0 && !holes_.empty()) {
+      // Everything on the hole stack is stale.
+      holes_.clear();
+    }
+    if (topIndex == alloc_entries_) {
+      std::string error_msg;
+      if (topIndex == max_entries_ ||
+          !Resize(std::min(alloc_entries_ * 2, max_entries_), &error_msg)) {
+        LOG(FATAL) << "JNI ERROR (app bug): " << kind_ << " table overflow "
+                   << "(max=" << max_entries_ << ") " << error_msg << "\n"
+                   << MutatorLockedDumpable<IndirectReferenceTable>(*this);
+      }
+    }
     index = topIndex++;
     segment_state_.parts.topIndex = topIndex;
   }
-  table_[index].Add(obj);
+  table_.LoadRelaxed()[index].Add(obj);
   result = ToIndirectRef(index);
   if (false) {
     LOG(INFO) << "+++ added at " << ExtractIndex(result) << " top=" << segment_state_.parts.topIndex
@@ -156,7 +208,8 @@ bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
   int topIndex = segment_state_.parts.topIndex;
   int bottomIndex = prevState.parts.topIndex;
 
-  DCHECK(table_ != NULL);
+  IrtEntry* const table = table_.LoadRelaxed();
+  DCHECK(table != NULL);
   DCHECK_GE(segment_state_.parts.numHoles, prevState.parts.numHoles);
 
   if (GetIndirectRefKind(iref) == kHandleScopeOrInvalid &&
@@ -185,16 +238,16 @@ bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
       return false;
     }
 
-    *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+    *table[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
     int numHoles = segment_state_.parts.numHoles - prevState.parts.numHoles;
     if (numHoles != 0) {
       while (--topIndex > bottomIndex && numHoles != 0) {
         if (false) {
           LOG(INFO) << "+++ checking for hole at " << topIndex - 1
                     << " (cookie=" << cookie << ") val="
-                    << table_[topIndex - 1].GetReference()->Read<kWithoutReadBarrier>();
+                    << table[topIndex - 1].GetReference()->Read<kWithoutReadBarrier>();
         }
-        if (!table_[topIndex - 1].GetReference()->IsNull()) {
+        if (!table[topIndex - 1].GetReference()->IsNull()) {
           break;
         }
         if (false) {
@@ -214,7 +267,7 @@ bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
     // Not the top-most entry.  This creates a hole.  We NULL out the
     // entry to prevent somebody from deleting it twice and screwing up
     // the hole count.
-    if (table_[idx].GetReference()->IsNull()) {
+    if (table[idx].GetReference()->IsNull()) {
       LOG(INFO) << "--- WEIRD: removing null entry " << idx;
       return false;
     }
@@ -222,8 +275,13 @@ bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
       return false;
     }
 
-    *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+    *table[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
     segment_state_.parts.numHoles++;
+    if (holes_.size() >= 2 * segment_state_.parts.numHoles + kMinStaleHoles) {
+      CompactHoles();
+    } else {
+      holes_.push_back(idx);
+    }
     if (false) {
       LOG(INFO) << "+++ left hole at " << idx << ", holes=" << segment_state_.parts.numHoles;
     }
@@ -234,7 +292,8 @@ bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
 
 void IndirectReferenceTable::Trim() {
   const size_t top_index = Capacity();
-  auto* release_start = AlignUp(reinterpret_cast<uint8_t*>(&table_[top_index]), kPageSize);
+  IrtEntry* const table = table_.LoadRelaxed();
+  auto* release_start = AlignUp(reinterpret_cast<uint8_t*>(&table[top_index]), kPageSize);
   uint8_t* release_end = table_mem_map_->End();
   madvise(release_start, release_end - release_start, MADV_DONTNEED);
 }
@@ -250,8 +309,9 @@ void IndirectReferenceTable::VisitRoots(RootCallback* callback, void* arg,
 void IndirectReferenceTable::Dump(std::ostream& os) const {
   os << kind_ << " table dump:\n";
   ReferenceTable::Table entries;
+  IrtEntry* const table = table_.LoadRelaxed();
   for (size_t i = 0; i < Capacity(); ++i) {
-    mirror::Object* obj = table_[i].GetReference()->Read<kWithoutReadBarrier>();
+    mirror::Object* obj = table[i].GetReference()->Read<kWithoutReadBarrier>();
     if (UNLIKELY(obj == nullptr)) {
       // Remove NULLs.
     } else if (UNLIKELY(obj == kClearedJniWeakGlobal)) {
@@ -259,7 +319,7 @@ void IndirectReferenceTable::Dump(std::ostream& os) const {
       // while the read barrier won't.
       entries.push_back(GcRoot<mirror::Object>(obj));
     } else {
-      obj = table_[i].GetReference()->Read();
+      obj = table[i].GetReference()->Read();
       entries.push_back(GcRoot<mirror::Object>(obj));
     }
   }
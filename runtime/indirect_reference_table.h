@@ -21,7 +21,9 @@
 
 #include <iosfwd>
 #include <string>
+#include <vector>
 
+#include "atomic.h"
 #include "base/logging.h"
 #include "base/mutex.h"
 #include "gc_root.h"
@@ -144,11 +146,20 @@ static const uint32_t IRT_FIRST_SEGMENT = 0;
  * If "alloc_entries_" is not equal to "max_entries_", the table may expand
  * when entries are added, which means the memory may move.  If you want
  * to keep pointers into "table" rather than offsets, you must use a
- * fixed-size table.
+ * fixed-size table.  The table starts out with room for the initial count
+ * and doubles until it reaches the maximum.  Local tables are only used by
+ * their thread, so the old storage is released right away.  Global tables
+ * are read without a lock, so their old storage is kept until the table
+ * is destroyed.
  *
  * If we delete entries from the middle of the list, we will be left with
  * "holes".  We track the number of holes so that, when adding new elements,
- * we can quickly decide to do a trivial append or go slot-hunting.
+ * we can quickly decide to do a trivial append or fill a hole.  The index
+ * of each hole is also pushed on a stack when it is made, so filling one
+ * does not need a scan.  Entries on the stack are not updated when a hole
+ * goes away by other means, so they are checked when popped.  Because
+ * segments are pushed and popped in stack order, the holes of the current
+ * segment are always above those of the segments below it.
  *
  * When the top-most entry is removed, any holes immediately below it are
  * also removed.  Thus, deletion of an entry may reduce "topIndex" by more
@@ -178,11 +189,6 @@ static const uint32_t IRT_FIRST_SEGMENT = 0;
  * stale references aren't possible (though we may be able to get similar
  * benefits with other approaches).
  *
- * TODO: consider a "lastDeleteIndex" for quick hole-filling when an
- * add immediately follows a delete; must invalidate after segment pop
- * (which could increase the cost/complexity of method call/return).
- * Might be worth only using it for JNI globals.
- *
  * TODO: may want completely different add/remove algorithms for global
  * and local refs to improve performance.  A large circular buffer might
  * reduce the amortized cost of adding global references.
@@ -277,8 +283,8 @@ class IndirectReferenceTable {
   /*
    * Add a new entry.  "obj" must be a valid non-NULL object reference.
    *
-   * Returns NULL if the table is full (max entries reached, or alloc
-   * failed during expansion).
+   * Aborts if the table is full (max entries reached, or alloc failed
+   * during expansion).
    */
   IndirectRef Add(uint32_t cookie, mirror::Object* obj)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -292,7 +298,8 @@ class IndirectReferenceTable {
   mirror::Object* Get(IndirectRef iref) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       ALWAYS_INLINE;
 
-  // Synchronized get which reads a reference, acquiring a lock if necessary.
+  // Synchronized get which reads a reference, acquiring a lock if necessary. No lock is needed
+  // as Get loads the table with acquire ordering, which pairs with the release in Resize.
   template<ReadBarrierOption kReadBarrierOption = kWithReadBarrier>
   mirror::Object* SynchronizedGet(Thread* /*self*/, ReaderWriterMutex* /*mutex*/,
                                   IndirectRef iref) const
@@ -325,11 +332,11 @@ class IndirectReferenceTable {
 
   // Note IrtIterator does not have a read barrier as it's used to visit roots.
   IrtIterator begin() {
-    return IrtIterator(table_, 0, Capacity());
+    return IrtIterator(table_.LoadRelaxed(), 0, Capacity());
   }
 
   IrtIterator end() {
-    return IrtIterator(table_, Capacity(), Capacity());
+    return IrtIterator(table_.LoadRelaxed(), Capacity(), Capacity());
   }
 
   void VisitRoots(RootCallback* callback, void* arg, const RootInfo& root_info)
@@ -350,6 +357,11 @@ class IndirectReferenceTable {
   // Release pages past the end of the table that may have previously held references.
   void Trim() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Number of entries the table has room for before it needs to expand.
+  size_t AllocatedCount() const {
+    return alloc_entries_;
+  }
+
  private:
   // Extract the table index from an indirect reference.
   static uint32_t ExtractIndex(IndirectRef iref) {
@@ -363,7 +375,7 @@ class IndirectReferenceTable {
    */
   IndirectRef ToIndirectRef(uint32_t tableIndex) const {
     DCHECK_LT(tableIndex, 65536U);
-    uint32_t serialChunk = table_[tableIndex].GetSerial();
+    uint32_t serialChunk = table_.LoadAcquire()[tableIndex].GetSerial();
     uintptr_t uref = (serialChunk << 20) | (tableIndex << 2) | kind_;
     return reinterpret_cast<IndirectRef>(uref);
   }
@@ -375,16 +387,34 @@ class IndirectReferenceTable {
   bool GetChecked(IndirectRef) const;
   bool CheckEntry(const char*, IndirectRef, int) const;
 
+  // Move the table to new storage with room for new_count entries.
+  bool Resize(size_t new_count, std::string* error_msg);
+
+  // Pop the most recent hole in [bottom_index, top_index) off the hole stack.
+  size_t TakeHole(size_t bottom_index, size_t top_index)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Rebuild the hole stack from the table once it has too many stale entries.
+  void CompactHoles();
+
   /* semi-public - read/write by jni down calls */
   IRTSegmentState segment_state_;
 
   // Mem map where we store the indirect refs.
   std::unique_ptr<MemMap> table_mem_map_;
+  // Storage of global tables from before they expanded, which unlocked readers may still use.
+  std::vector<std::unique_ptr<MemMap>> old_table_mem_maps_;
   // bottom of the stack. Do not directly access the object references
   // in this as they are roots. Use Get() that has a read barrier.
-  IrtEntry* table_;
+  // Resize publishes a new table with a release store, so lock-free readers load it with
+  // acquire; the owner of the table can load it relaxed.
+  Atomic<IrtEntry*> table_;
+  // Indices of holes, most recent last. May contain stale entries.
+  std::vector<uint32_t> holes_;
   /* bit mask, ORed into all irefs */
   const IndirectRefKind kind_;
+  /* #of entries the table has room for */
+  size_t alloc_entries_;
   /* max #of entries allowed */
   const size_t max_entries_;
 };
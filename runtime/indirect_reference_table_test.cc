@@ -250,4 +250,150 @@ TEST_F(IndirectReferenceTableTest, BasicTest) {
   CheckDump(&irt, 0, 0);
 }
 
+TEST_F(IndirectReferenceTableTest, Growth) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableInitial = 1;
+  static const size_t kTableMax = 4096;
+  IndirectReferenceTable irt(kTableInitial, kTableMax, kLocal);
+  const uint32_t cookie = IRT_FIRST_SEGMENT;
+
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  const size_t initial_allocated = irt.AllocatedCount();
+  ASSERT_GE(initial_allocated, kTableInitial);
+  ASSERT_LT(initial_allocated, kTableMax);
+
+  // Fill the table to its maximum, checking that earlier refs survive each expansion.
+  std::vector<IndirectRef> refs;
+  std::vector<mirror::Object*> objs;
+  for (size_t i = 0; i < kTableMax; ++i) {
+    mirror::Object* obj = c->AllocObject(soa.Self());
+    ASSERT_TRUE(obj != nullptr);
+    refs.push_back(irt.Add(cookie, obj));
+    objs.push_back(obj);
+    ASSERT_TRUE(refs.back() != nullptr);
+  }
+  EXPECT_EQ(kTableMax, irt.AllocatedCount());
+  EXPECT_EQ(kTableMax, irt.Capacity());
+  for (size_t i = 0; i < kTableMax; ++i) {
+    EXPECT_EQ(objs[i], irt.Get(refs[i])) << i;
+  }
+  for (size_t i = kTableMax; i != 0; --i) {
+    ASSERT_TRUE(irt.Remove(cookie, refs[i - 1]));
+  }
+  EXPECT_EQ(0U, irt.Capacity());
+}
+
+TEST_F(IndirectReferenceTableTest, HoleReuse) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableInitial = 16;
+  static const size_t kTableMax = 64;
+  IndirectReferenceTable irt(kTableInitial, kTableMax, kLocal);
+
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  mirror::Object* obj0 = c->AllocObject(soa.Self());
+  ASSERT_TRUE(obj0 != nullptr);
+
+  // Make holes at 1 and 2 in the first segment.
+  const uint32_t cookie0 = IRT_FIRST_SEGMENT;
+  IndirectRef refs[4];
+  for (size_t i = 0; i < arraysize(refs); ++i) {
+    refs[i] = irt.Add(cookie0, obj0);
+  }
+  ASSERT_TRUE(irt.Remove(cookie0, refs[1]));
+  ASSERT_TRUE(irt.Remove(cookie0, refs[2]));
+  ASSERT_EQ(4U, irt.Capacity());
+
+  // A pushed segment fills its own holes, not those below it.
+  const uint32_t cookie1 = irt.GetSegmentState();
+  IndirectRef inner[3];
+  for (size_t i = 0; i < arraysize(inner); ++i) {
+    inner[i] = irt.Add(cookie1, obj0);
+  }
+  ASSERT_TRUE(irt.Remove(cookie1, inner[0]));
+  ASSERT_TRUE(irt.Remove(cookie1, inner[1]));
+  ASSERT_EQ(7U, irt.Capacity());
+  IndirectRef filled = irt.Add(cookie1, obj0);
+  ASSERT_TRUE(filled != nullptr);
+  ASSERT_EQ(7U, irt.Capacity());
+  EXPECT_EQ(obj0, irt.Get(filled));
+  filled = irt.Add(cookie1, obj0);
+  ASSERT_TRUE(filled != nullptr);
+  ASSERT_EQ(7U, irt.Capacity());
+  // No holes left in this segment, so this one is appended.
+  filled = irt.Add(cookie1, obj0);
+  ASSERT_EQ(8U, irt.Capacity());
+  ASSERT_TRUE(irt.Remove(cookie1, inner[2]));
+
+  // Pop the segment, leaving a stale entry for its last hole on the hole stack.
+  irt.SetSegmentState(cookie1);
+  ASSERT_EQ(4U, irt.Capacity());
+
+  // The first segment gets its two holes back and then appends.
+  for (size_t i = 0; i < 2; ++i) {
+    filled = irt.Add(cookie0, obj0);
+    ASSERT_TRUE(filled != nullptr);
+    ASSERT_EQ(4U, irt.Capacity());
+  }
+  filled = irt.Add(cookie0, obj0);
+  ASSERT_EQ(5U, irt.Capacity());
+  CheckDump(&irt, 5, 1);
+}
+
+// Many rounds of removals followed by additions must keep reusing the holes, so neither table
+// grows past the entries that are live at the same time.
+TEST_F(IndirectReferenceTableTest, HoleChurn) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kIterations = 10000;
+  static const size_t kRefsPerFrame = 16;
+
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  mirror::Object* obj0 = c->AllocObject(soa.Self());
+  ASSERT_TRUE(obj0 != nullptr);
+
+  // Local references: push a segment, add to it, delete one from the middle and pop it, as a
+  // native method that calls DeleteLocalRef would.
+  IndirectReferenceTable locals(64, 512, kLocal);
+  const size_t locals_allocated = locals.AllocatedCount();
+  IndirectRef refs[kRefsPerFrame];
+  for (size_t i = 0; i < kIterations; ++i) {
+    const uint32_t cookie = locals.GetSegmentState();
+    for (size_t j = 0; j < kRefsPerFrame; ++j) {
+      refs[j] = locals.Add(cookie, obj0);
+    }
+    ASSERT_TRUE(locals.Remove(cookie, refs[kRefsPerFrame / 2]));
+    refs[kRefsPerFrame / 2] = locals.Add(cookie, obj0);
+    ASSERT_EQ(kRefsPerFrame, locals.Capacity());
+    ASSERT_EQ(obj0, locals.Get(refs[kRefsPerFrame / 2]));
+    locals.SetSegmentState(cookie);
+  }
+  EXPECT_EQ(0U, locals.Capacity());
+  EXPECT_EQ(locals_allocated, locals.AllocatedCount());
+
+  // Global references: create and delete out of order in a table with many live entries.
+  static const size_t kLiveGlobals = 4096;
+  IndirectReferenceTable globals(512, 51200, kGlobal);
+  const uint32_t cookie = IRT_FIRST_SEGMENT;
+  std::vector<IndirectRef> live;
+  for (size_t i = 0; i < kLiveGlobals; ++i) {
+    live.push_back(globals.Add(cookie, obj0));
+  }
+  const size_t globals_allocated = globals.AllocatedCount();
+  ASSERT_GE(globals_allocated, kLiveGlobals);
+  for (size_t i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < kRefsPerFrame; ++j) {
+      const size_t victim = (i * kRefsPerFrame + j) * 7919 % live.size();
+      ASSERT_TRUE(globals.Remove(cookie, live[victim]));
+      live[victim] = globals.Add(cookie, obj0);
+    }
+    ASSERT_EQ(kLiveGlobals, globals.Capacity());
+  }
+  EXPECT_EQ(globals_allocated, globals.AllocatedCount());
+  for (IndirectRef ref : live) {
+    EXPECT_EQ(obj0, globals.Get(ref));
+  }
+}
+
 }  // namespace art
@@ -60,6 +60,7 @@ static bool InstallStubsClassVisitor(mirror::Class* klass, void* arg)
 
 Instrumentation::Instrumentation()
     : instrumentation_stubs_installed_(false), entry_exit_stubs_installed_(false),
+      have_watched_methods_(false),
       interpreter_stubs_installed_(false),
       interpret_only_(false), forced_interpret_only_(false),
       have_method_entry_listeners_(false), have_method_exit_listeners_(false),
@@ -190,6 +191,15 @@ void Instrumentation::InstallStubsForMethod(mirror::ArtMethod* method) {
       }
     }
   }
+  // A watched method keeps the entry stub whatever else is installed, the stub picks the code to
+  // run. The resolution trampoline is kept, see ClassLinker::FixupStaticTrampolines.
+  if (IsWatched(method) && new_quick_code != class_linker->GetQuickResolutionTrampoline()) {
+#if defined(ART_USE_PORTABLE_COMPILER)
+    new_portable_code = GetPortableToInterpreterBridge();
+#endif
+    new_quick_code = GetQuickInstrumentationEntryPoint();
+    have_portable_code = false;
+  }
   UpdateEntrypoints(method, new_quick_code, new_portable_code, have_portable_code);
 }
 
@@ -602,20 +612,60 @@ void Instrumentation::ConfigureStubs(bool require_entry_exit_stubs, bool require
     interpreter_stubs_installed_ = false;
     entry_exit_stubs_installed_ = false;
     runtime->GetClassLinker()->VisitClasses(InstallStubsClassVisitor, this);
-    // Restore stack only if there is no method currently deoptimized.
-    bool empty;
-    {
-      ReaderMutexLock mu(self, deoptimized_methods_lock_);
-      empty = IsDeoptimizedMethodsEmpty();  // Avoid lock violation.
-    }
-    if (empty) {
-      instrumentation_stubs_installed_ = false;
+    MaybeRestoreStacks();
+  }
+}
+
+void Instrumentation::MaybeRestoreStacks() {
+  if (entry_exit_stubs_installed_ || interpreter_stubs_installed_) {
+    return;
+  }
+  // Restore stack only if there is no method currently deoptimized.
+  Thread* const self = Thread::Current();
+  bool empty;
+  {
+    ReaderMutexLock mu(self, deoptimized_methods_lock_);
+    empty = IsDeoptimizedMethodsEmpty();  // Avoid lock violation.
+  }
+  if (empty) {
+    instrumentation_stubs_installed_ = false;
+    // Watched methods still need the exit stub.
+    if (!have_watched_methods_) {
       MutexLock mu(self, *Locks::thread_list_lock_);
       Runtime::Current()->GetThreadList()->ForEach(InstrumentationRestoreStack, this);
     }
   }
 }
 
+void Instrumentation::AddMethodListener(InstrumentationListener* listener,
+                                        mirror::ArtMethod* method) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  CHECK(!method->IsProxyMethod());
+  CHECK(!method->IsAbstract());
+  method_listeners_.insert(std::make_pair(method, listener));
+  // Frames entered through the stub return to the exit stub, which stack walks have to know
+  // about. Frames already on a stack are left alone.
+  have_watched_methods_ = true;
+  InstallStubsForMethod(method);
+}
+
+void Instrumentation::RemoveMethodListener(InstrumentationListener* listener,
+                                           mirror::ArtMethod* method) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  auto range = method_listeners_.equal_range(method);
+  auto it = range.first;
+  while (it != range.second && it->second != listener) {
+    ++it;
+  }
+  CHECK(it != range.second) << "No listener for " << PrettyMethod(method);
+  method_listeners_.erase(it);
+  if (!IsWatched(method)) {
+    have_watched_methods_ = !method_listeners_.empty();
+    InstallStubsForMethod(method);
+    MaybeRestoreStacks();
+  }
+}
+
 static void ResetQuickAllocEntryPointsForThread(Thread* thread, void* arg) {
   thread->ResetQuickAllocEntryPointsForThread();
 }
@@ -681,12 +731,22 @@ void Instrumentation::UpdateMethodsCode(mirror::ArtMethod* method, const void* q
   const void* new_portable_code;
   const void* new_quick_code;
   bool new_have_portable_code;
-  if (LIKELY(!instrumentation_stubs_installed_)) {
+  if (LIKELY(!instrumentation_stubs_installed_) && !IsWatched(method)) {
     new_portable_code = portable_code;
     new_quick_code = quick_code;
     new_have_portable_code = have_portable_code;
   } else {
-    if ((interpreter_stubs_installed_ || IsDeoptimized(method)) && !method->IsNative()) {
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    if (IsWatched(method) && quick_code != class_linker->GetQuickResolutionTrampoline()) {
+      // The entry stub picks the code to run, see artInstrumentationMethodEntryFromCode.
+      new_quick_code = GetQuickInstrumentationEntryPoint();
+#if defined(ART_USE_PORTABLE_COMPILER)
+      new_portable_code = GetPortableToInterpreterBridge();
+#else
+      new_portable_code = portable_code;
+#endif
+      new_have_portable_code = false;
+    } else if ((interpreter_stubs_installed_ || IsDeoptimized(method)) && !method->IsNative()) {
 #if defined(ART_USE_PORTABLE_COMPILER)
       new_portable_code = GetPortableToInterpreterBridge();
 #else
@@ -695,7 +755,6 @@ void Instrumentation::UpdateMethodsCode(mirror::ArtMethod* method, const void* q
       new_quick_code = GetQuickToInterpreterBridge();
       new_have_portable_code = false;
     } else {
-      ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
       if (quick_code == class_linker->GetQuickResolutionTrampoline() ||
           quick_code == class_linker->GetQuickToInterpreterBridgeTrampoline() ||
           quick_code == GetQuickToInterpreterBridge()) {
@@ -837,6 +896,15 @@ void Instrumentation::Undeoptimize(mirror::ArtMethod* method) {
                         class_linker->GetPortableResolutionTrampoline(),
 #else
                         nullptr,
+#endif
+                        false);
+    } else if (IsWatched(method)) {
+      // Keep the entry stub, which now picks the compiled code.
+      UpdateEntrypoints(method, GetQuickInstrumentationEntryPoint(),
+#if defined(ART_USE_PORTABLE_COMPILER)
+                        GetPortableToInterpreterBridge(),
+#else
+                        nullptr,
 #endif
                         false);
     } else {
@@ -850,10 +918,13 @@ void Instrumentation::Undeoptimize(mirror::ArtMethod* method) {
       UpdateEntrypoints(method, quick_code, portable_code, have_portable_code);
     }
 
-    // If there is no deoptimized method left, we can restore the stack of each thread.
+    // If there is no deoptimized method left, we can restore the stack of each thread. Watched
+    // methods still need the exit stub.
     if (empty) {
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      Runtime::Current()->GetThreadList()->ForEach(InstrumentationRestoreStack, this);
+      if (!have_watched_methods_) {
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        Runtime::Current()->GetThreadList()->ForEach(InstrumentationRestoreStack, this);
+      }
       instrumentation_stubs_installed_ = false;
     }
   }
@@ -924,9 +995,11 @@ const void* Instrumentation::GetQuickCodeFor(mirror::ArtMethod* method, size_t p
     const void* code = method->GetEntryPointFromQuickCompiledCodePtrSize(pointer_size);
     DCHECK(code != nullptr);
     ClassLinker* class_linker = runtime->GetClassLinker();
+    // Only watched methods have the entry stub as their code when no stubs are installed.
     if (LIKELY(code != class_linker->GetQuickResolutionTrampoline()) &&
         LIKELY(code != class_linker->GetQuickToInterpreterBridgeTrampoline()) &&
-        LIKELY(code != GetQuickToInterpreterBridge())) {
+        LIKELY(code != GetQuickToInterpreterBridge()) &&
+        LIKELY(code != GetQuickInstrumentationEntryPoint())) {
       return code;
     }
   }
@@ -971,6 +1044,33 @@ void Instrumentation::MethodUnwindEvent(Thread* thread, mirror::Object* this_obj
   }
 }
 
+void Instrumentation::WatchedMethodEnterEvent(Thread* thread, mirror::Object* this_object,
+                                              mirror::ArtMethod* method,
+                                              uint32_t dex_pc) const {
+  auto range = method_listeners_.equal_range(method);
+  for (auto it = range.first; it != range.second; ++it) {
+    it->second->MethodEntered(thread, this_object, method, dex_pc);
+  }
+}
+
+void Instrumentation::WatchedMethodExitEvent(Thread* thread, mirror::Object* this_object,
+                                             mirror::ArtMethod* method, uint32_t dex_pc,
+                                             const JValue& return_value) const {
+  auto range = method_listeners_.equal_range(method);
+  for (auto it = range.first; it != range.second; ++it) {
+    it->second->MethodExited(thread, this_object, method, dex_pc, return_value);
+  }
+}
+
+void Instrumentation::WatchedMethodUnwindEvent(Thread* thread, mirror::Object* this_object,
+                                               mirror::ArtMethod* method,
+                                               uint32_t dex_pc) const {
+  auto range = method_listeners_.equal_range(method);
+  for (auto it = range.first; it != range.second; ++it) {
+    it->second->MethodUnwind(thread, this_object, method, dex_pc);
+  }
+}
+
 void Instrumentation::DexPcMovedEventImpl(Thread* thread, mirror::Object* this_object,
                                           mirror::ArtMethod* method,
                                           uint32_t dex_pc) const {
@@ -1050,6 +1150,10 @@ void Instrumentation::PushInstrumentationStackFrame(Thread* self, mirror::Object
   if (!interpreter_entry) {
     MethodEnterEvent(self, this_object, method, 0);
   }
+  // The interpreter only reports to the listeners of all methods.
+  if (UNLIKELY(!method_listeners_.empty())) {
+    WatchedMethodEnterEvent(self, this_object, method, 0);
+  }
 }
 
 TwoWordReturn Instrumentation::PopInstrumentationStackFrame(Thread* self, uintptr_t* return_pc,
@@ -1083,6 +1187,9 @@ TwoWordReturn Instrumentation::PopInstrumentationStackFrame(Thread* self, uintpt
   if (!instrumentation_frame.interpreter_entry_) {
     MethodExitEvent(self, this_object, instrumentation_frame.method_, dex_pc, return_value);
   }
+  if (UNLIKELY(!method_listeners_.empty())) {
+    WatchedMethodExitEvent(self, this_object, method, dex_pc, return_value);
+  }
 
   // Deoptimize if the caller needs to continue execution in the interpreter. Do nothing if we get
   // back to an upcall.
@@ -1132,6 +1239,9 @@ void Instrumentation::PopMethodForUnwind(Thread* self, bool is_deoptimization) c
     //       return_pc.
     uint32_t dex_pc = DexFile::kDexNoIndex;
     MethodUnwindEvent(self, instrumentation_frame.this_object_, method, dex_pc);
+    if (UNLIKELY(!method_listeners_.empty())) {
+      WatchedMethodUnwindEvent(self, instrumentation_frame.this_object_, method, dex_pc);
+    }
   }
 }
 
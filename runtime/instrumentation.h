@@ -127,6 +127,26 @@ class Instrumentation {
       EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
       LOCKS_EXCLUDED(Locks::thread_list_lock_, Locks::classlinker_classes_lock_);
 
+  // Add a listener to be notified of the entry, exit and unwind of a single method. Only that
+  // method is routed through the instrumentation entry stub, which patches the return address of
+  // its new frames to get the exit; everything else keeps running its compiled code and no stack
+  // is walked. Frames of the method already on a stack are not reported. The listener is not
+  // told about other methods, and it is not registered for any event of AddListener.
+  void AddMethodListener(InstrumentationListener* listener, mirror::ArtMethod* method)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(deoptimized_methods_lock_);
+
+  // Removes a listener added with AddMethodListener, restoring the method's code if nothing else
+  // listens to it.
+  void RemoveMethodListener(InstrumentationListener* listener, mirror::ArtMethod* method)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::thread_list_lock_, deoptimized_methods_lock_);
+
+  // Does method have listeners added with AddMethodListener?
+  bool IsWatched(mirror::ArtMethod* method) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return UNLIKELY(!method_listeners_.empty()) && method_listeners_.count(method) != 0;
+  }
+
   // Deoptimization.
   void EnableDeoptimization()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
@@ -221,8 +241,9 @@ class Instrumentation {
     return instrumentation_stubs_installed_;
   }
 
+  // Frames of watched methods return to the exit stub too, even when no other stub is installed.
   bool AreExitStubsInstalled() const {
-    return instrumentation_stubs_installed_;
+    return instrumentation_stubs_installed_ || have_watched_methods_;
   }
 
   bool HasMethodEntryListeners() const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
@@ -374,6 +395,23 @@ class Instrumentation {
                            mirror::ArtMethod* method, uint32_t dex_pc,
                            mirror::ArtField* field, const JValue& field_value) const
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Notify the listeners added with AddMethodListener for method.
+  void WatchedMethodEnterEvent(Thread* thread, mirror::Object* this_object,
+                               mirror::ArtMethod* method, uint32_t dex_pc) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void WatchedMethodExitEvent(Thread* thread, mirror::Object* this_object,
+                              mirror::ArtMethod* method, uint32_t dex_pc,
+                              const JValue& return_value) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void WatchedMethodUnwindEvent(Thread* thread, mirror::Object* this_object,
+                                mirror::ArtMethod* method, uint32_t dex_pc) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Clear instrumentation_stubs_installed_ if no stub or deoptimized method needs it any more,
+  // and restore the return addresses of all threads if no watched method needs them either.
+  void MaybeRestoreStacks()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::thread_list_lock_, deoptimized_methods_lock_);
 
   // Read barrier-aware utility functions for accessing deoptimized_methods_
   bool AddDeoptimizedMethod(mirror::ArtMethod* method)
@@ -398,6 +436,10 @@ class Instrumentation {
   // Have we hijacked ArtMethod::code_ to reference the enter/exit stubs?
   bool entry_exit_stubs_installed_;
 
+  // Do some methods have listeners added with AddMethodListener? Only their code references the
+  // enter stub, so this does not set instrumentation_stubs_installed_.
+  bool have_watched_methods_;
+
   // Have we hijacked ArtMethod::code_ to reference the enter interpreter stub?
   bool interpreter_stubs_installed_;
 
@@ -447,6 +489,13 @@ class Instrumentation {
   std::shared_ptr<std::list<InstrumentationListener*>> exception_caught_listeners_
       GUARDED_BY(Locks::mutator_lock_);
 
+  // The listeners of single methods, written to with the mutator_lock_ exclusively held. Methods
+  // are not moved by the GC (see kMovingMethods) so they are used as keys directly. Every watched
+  // method has the instrumentation entry stub as its code, or the resolution trampoline until its
+  // class is initialized.
+  std::multimap<mirror::ArtMethod*, InstrumentationListener*> method_listeners_
+      GUARDED_BY(Locks::mutator_lock_);
+
   // The set of methods being deoptimized (by the debugger) which must be executed with interpreter
   // only.
   mutable ReaderWriterMutex deoptimized_methods_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "instrumentation.h"
+
+#include <utility>
+#include <vector>
+
+#include "class_linker.h"
+#include "common_compiler_test.h"
+#include "entrypoints/entrypoint_utils.h"
+#include "handle_scope-inl.h"
+#include "jvalue.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change.h"
+#include "thread_list.h"
+
+namespace art {
+namespace instrumentation {
+
+typedef std::pair<uint32_t, mirror::ArtMethod*> Event;
+
+// Records every event it is told about.
+class RecordingListener : public InstrumentationListener {
+ public:
+  void MethodEntered(Thread*, mirror::Object*, mirror::ArtMethod* method, uint32_t)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kMethodEntered, method));
+  }
+
+  void MethodExited(Thread*, mirror::Object*, mirror::ArtMethod* method, uint32_t,
+                    const JValue&) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kMethodExited, method));
+  }
+
+  void MethodUnwind(Thread*, mirror::Object*, mirror::ArtMethod* method, uint32_t)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kMethodUnwind, method));
+  }
+
+  void DexPcMoved(Thread*, mirror::Object*, mirror::ArtMethod* method, uint32_t)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kDexPcMoved, method));
+  }
+
+  void FieldRead(Thread*, mirror::Object*, mirror::ArtMethod* method, uint32_t,
+                 mirror::ArtField*) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kFieldRead, method));
+  }
+
+  void FieldWritten(Thread*, mirror::Object*, mirror::ArtMethod* method, uint32_t,
+                    mirror::ArtField*, const JValue&) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kFieldWritten, method));
+  }
+
+  void ExceptionCaught(Thread*, const ThrowLocation&, mirror::ArtMethod* catch_method, uint32_t,
+                       mirror::Throwable*) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) OVERRIDE {
+    events_.push_back(Event(Instrumentation::kExceptionCaught, catch_method));
+  }
+
+  std::vector<Event> events_;
+};
+
+class InstrumentationTest : public CommonCompilerTest {
+ protected:
+  virtual void SetUp() {
+    CommonCompilerTest::SetUp();
+    ScopedObjectAccess soa(Thread::Current());
+    jobject jclass_loader = LoadDex("InstrumentedMethods");
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader*>(jclass_loader)));
+    MakeExecutable(class_loader.Get(), "InstrumentedMethods");
+    Handle<mirror::Class> klass(
+        hs.NewHandle(class_linker_->FindClass(soa.Self(), "LInstrumentedMethods;", class_loader)));
+    ASSERT_TRUE(klass.Get() != nullptr);
+    ASSERT_TRUE(class_linker_->EnsureInitialized(klass, true, true));
+    watched_ = klass->FindDirectMethod("watched", "(I)I");
+    unwatched_ = klass->FindDirectMethod("unwatched", "(I)I");
+    call_both_ = klass->FindDirectMethod("callBoth", "(I)I");
+    fail_ = klass->FindDirectMethod("fail", "()V");
+    ASSERT_TRUE(watched_ != nullptr);
+    ASSERT_TRUE(unwatched_ != nullptr);
+    ASSERT_TRUE(call_both_ != nullptr);
+    ASSERT_TRUE(fail_ != nullptr);
+    watched_code_ = watched_->GetEntryPointFromQuickCompiledCode();
+    unwatched_code_ = unwatched_->GetEntryPointFromQuickCompiledCode();
+
+    bool started = runtime_->Start();
+    CHECK(started);
+    soa.Self()->TransitionFromSuspendedToRunnable();
+  }
+
+  Instrumentation* GetInstrumentation() {
+    return Runtime::Current()->GetInstrumentation();
+  }
+
+  // Changes to the instrumentation need all threads suspended, like in Trace::Start.
+  void SuspendAll() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    Thread::Current()->TransitionFromRunnableToSuspended(kSuspended);
+    Runtime::Current()->GetThreadList()->SuspendAll();
+  }
+
+  void ResumeAll() EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    Runtime::Current()->GetThreadList()->ResumeAll();
+    Thread::Current()->TransitionFromSuspendedToRunnable();
+  }
+
+  void Watch(InstrumentationListener* listener, mirror::ArtMethod* method)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    SuspendAll();
+    GetInstrumentation()->AddMethodListener(listener, method);
+    ResumeAll();
+  }
+
+  void Unwatch(InstrumentationListener* listener, mirror::ArtMethod* method)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    SuspendAll();
+    GetInstrumentation()->RemoveMethodListener(listener, method);
+    ResumeAll();
+  }
+
+  int32_t InvokeInt(mirror::ArtMethod* method, int32_t arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    uint32_t args[1] = { static_cast<uint32_t>(arg) };
+    JValue result;
+    method->Invoke(Thread::Current(), args, sizeof(args), &result, "II");
+    CHECK(!Thread::Current()->IsExceptionPending());
+    return result.GetI();
+  }
+
+  // Checks that the watched method reports its entry and exit, and that calling the other ones,
+  // directly or from compiled code, only reports the watched method.
+  void CheckWatchedEvents(RecordingListener* listener)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    listener->events_.clear();
+    EXPECT_EQ(12, InvokeInt(unwatched_, 10));
+    EXPECT_TRUE(listener->events_.empty());
+    EXPECT_EQ(11, InvokeInt(watched_, 10));
+    EXPECT_EQ(23, InvokeInt(call_both_, 10));
+    std::vector<Event> expected;
+    for (size_t i = 0; i != 2; ++i) {
+      expected.push_back(Event(Instrumentation::kMethodEntered, watched_));
+      expected.push_back(Event(Instrumentation::kMethodExited, watched_));
+    }
+    EXPECT_EQ(expected, listener->events_);
+    listener->events_.clear();
+  }
+
+  mirror::ArtMethod* watched_;
+  mirror::ArtMethod* unwatched_;
+  mirror::ArtMethod* call_both_;
+  mirror::ArtMethod* fail_;
+  const void* watched_code_;
+  const void* unwatched_code_;
+};
+
+TEST_F(InstrumentationTest, MethodListener) {
+  ScopedObjectAccess soa(Thread::Current());
+  Instrumentation* instrumentation = GetInstrumentation();
+  RecordingListener listener;
+  Watch(&listener, watched_);
+  EXPECT_EQ(GetQuickInstrumentationEntryPoint(), watched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_EQ(unwatched_code_, unwatched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_TRUE(instrumentation->AreExitStubsInstalled());
+  // Other methods keep the GetQuickCodeFor fast path: without an oat file the slow path would
+  // return the interpreter bridge.
+  EXPECT_EQ(unwatched_code_, instrumentation->GetQuickCodeFor(unwatched_, sizeof(void*)));
+  CheckWatchedEvents(&listener);
+  Unwatch(&listener, watched_);
+  EXPECT_EQ(watched_code_, watched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_FALSE(instrumentation->AreExitStubsInstalled());
+  EXPECT_EQ(11, InvokeInt(watched_, 10));
+  EXPECT_TRUE(listener.events_.empty());
+}
+
+TEST_F(InstrumentationTest, MethodListenerUnwind) {
+  ScopedObjectAccess soa(Thread::Current());
+  RecordingListener listener;
+  Watch(&listener, fail_);
+  JValue result;
+  fail_->Invoke(soa.Self(), nullptr, 0, &result, "V");
+  EXPECT_TRUE(soa.Self()->IsExceptionPending());
+  soa.Self()->ClearException();
+  std::vector<Event> expected;
+  expected.push_back(Event(Instrumentation::kMethodEntered, fail_));
+  expected.push_back(Event(Instrumentation::kMethodUnwind, fail_));
+  EXPECT_EQ(expected, listener.events_);
+  Unwatch(&listener, fail_);
+}
+
+TEST_F(InstrumentationTest, RemoveOneOfTwoMethodListeners) {
+  ScopedObjectAccess soa(Thread::Current());
+  RecordingListener first;
+  RecordingListener second;
+  Watch(&first, watched_);
+  Watch(&second, watched_);
+  Unwatch(&first, watched_);
+  EXPECT_EQ(GetQuickInstrumentationEntryPoint(), watched_->GetEntryPointFromQuickCompiledCode());
+  CheckWatchedEvents(&second);
+  EXPECT_TRUE(first.events_.empty());
+  Unwatch(&second, watched_);
+  EXPECT_EQ(watched_code_, watched_->GetEntryPointFromQuickCompiledCode());
+}
+
+TEST_F(InstrumentationTest, MethodListenerAndDeoptimize) {
+  ScopedObjectAccess soa(Thread::Current());
+  Instrumentation* instrumentation = GetInstrumentation();
+  RecordingListener listener;
+  Watch(&listener, watched_);
+  SuspendAll();
+  instrumentation->EnableDeoptimization();
+  instrumentation->Deoptimize(watched_);
+  ResumeAll();
+  CheckWatchedEvents(&listener);
+  // Undeoptimizing keeps the entry stub of the watched method.
+  SuspendAll();
+  instrumentation->Undeoptimize(watched_);
+  instrumentation->DisableDeoptimization();
+  ResumeAll();
+  EXPECT_EQ(GetQuickInstrumentationEntryPoint(), watched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_TRUE(instrumentation->AreExitStubsInstalled());
+  CheckWatchedEvents(&listener);
+  Unwatch(&listener, watched_);
+  EXPECT_EQ(watched_code_, watched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_FALSE(instrumentation->AreExitStubsInstalled());
+}
+
+TEST_F(InstrumentationTest, MethodListenerAndMethodTracing) {
+  ScopedObjectAccess soa(Thread::Current());
+  Instrumentation* instrumentation = GetInstrumentation();
+  RecordingListener listener;
+  Watch(&listener, watched_);
+  SuspendAll();
+  instrumentation->EnableMethodTracing();
+  ResumeAll();
+  CheckWatchedEvents(&listener);
+  // Disabling tracing restores the other methods but keeps the entry stub of the watched one.
+  SuspendAll();
+  instrumentation->DisableMethodTracing();
+  ResumeAll();
+  EXPECT_EQ(GetQuickInstrumentationEntryPoint(), watched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_EQ(unwatched_code_, unwatched_->GetEntryPointFromQuickCompiledCode());
+  EXPECT_TRUE(instrumentation->AreExitStubsInstalled());
+  CheckWatchedEvents(&listener);
+  Unwatch(&listener, watched_);
+  EXPECT_FALSE(instrumentation->AreExitStubsInstalled());
+}
+
+}  // namespace instrumentation
+}  // namespace art
@@ -16,6 +16,8 @@
 
 #include "intern_table.h"
 
+#include <sched.h>
+
 #include <memory>
 
 #include "gc/space/image_space.h"
@@ -31,12 +33,13 @@ namespace art {
 InternTable::InternTable()
     : image_added_to_intern_table_(false), log_new_roots_(false),
       allow_new_interns_(true),
-      new_intern_condition_("New intern condition", *Locks::intern_table_lock_) {
+      new_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+      weak_sweep_callback_(nullptr), weak_sweep_arg_(nullptr) {
 }
 
 size_t InternTable::Size() const {
   MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return strong_interns_.Size() + weak_interns_.Size() + new_weak_interns_.Size();
 }
 
 size_t InternTable::StrongSize() const {
@@ -46,7 +49,7 @@ size_t InternTable::StrongSize() const {
 
 size_t InternTable::WeakSize() const {
   MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return weak_interns_.Size();
+  return weak_interns_.Size() + new_weak_interns_.Size();
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
@@ -87,6 +90,20 @@ mirror::String* InternTable::LookupStrong(mirror::String* s) {
 }
 
 mirror::String* InternTable::LookupWeak(mirror::String* s) {
+  if (UNLIKELY(weak_sweep_callback_ != nullptr)) {
+    mirror::String* weak = new_weak_interns_.Find(s);
+    if (weak != nullptr) {
+      return weak;
+    }
+    weak = weak_interns_.Find(s);
+    if (weak == nullptr) {
+      return nullptr;
+    }
+    // Marking is done, so an unmarked weak intern is unreachable. Handing it out would resurrect
+    // it right before the sweep frees it.
+    mirror::Object* marked = weak_sweep_callback_(weak, weak_sweep_arg_);
+    return marked != nullptr ? marked->AsString() : nullptr;
+  }
   return weak_interns_.Find(s);
 }
 
@@ -113,7 +130,11 @@ mirror::String* InternTable::InsertWeak(mirror::String* s) {
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringInsertion(s);
   }
-  weak_interns_.Insert(s);
+  if (UNLIKELY(weak_sweep_callback_ != nullptr)) {
+    new_weak_interns_.Insert(s);
+  } else {
+    weak_interns_.Insert(s);
+  }
   return s;
 }
 
@@ -126,6 +147,14 @@ void InternTable::RemoveWeak(mirror::String* s) {
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringRemoval(s);
   }
+  if (UNLIKELY(weak_sweep_callback_ != nullptr)) {
+    if (new_weak_interns_.Find(s) == s) {
+      new_weak_interns_.Remove(s);
+    } else {
+      promoted_weak_interns_.push_back(GcRoot<mirror::String>(s));
+    }
+    return;
+  }
   weak_interns_.Remove(s);
 }
 
@@ -204,6 +233,16 @@ mirror::String* InternTable::LookupStringFromImage(mirror::String* s)
 void InternTable::AllowNewInterns() {
   Thread* self = Thread::Current();
   MutexLock mu(self, *Locks::intern_table_lock_);
+  if (weak_sweep_callback_ != nullptr) {
+    // The sweep is over, apply what happened to the weak interns in the meantime.
+    weak_sweep_callback_ = nullptr;
+    weak_sweep_arg_ = nullptr;
+    for (auto& root : promoted_weak_interns_) {
+      weak_interns_.Remove(root.Read());
+    }
+    promoted_weak_interns_.clear();
+    weak_interns_.AddAll(&new_weak_interns_);
+  }
   allow_new_interns_ = true;
   new_intern_condition_.Broadcast(self);
 }
@@ -220,7 +259,7 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong) {
   }
   Thread* self = Thread::Current();
   MutexLock mu(self, *Locks::intern_table_lock_);
-  while (UNLIKELY(!allow_new_interns_)) {
+  while (UNLIKELY(!allow_new_interns_ && weak_sweep_callback_ == nullptr)) {
     new_intern_condition_.WaitHoldingLocks(self);
   }
   // Check the strong table for a match.
@@ -272,8 +311,18 @@ bool InternTable::ContainsWeak(mirror::String* s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedCallback* callback, void* arg) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.SweepWeaks(callback, arg);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  if (allow_new_interns_) {
+    weak_interns_.SweepWeaks(callback, arg);
+    return;
+  }
+  // Let the threads waiting in Insert go on, sweeping may take a while for a big table.
+  DCHECK(weak_sweep_callback_ == nullptr);
+  weak_sweep_callback_ = callback;
+  weak_sweep_arg_ = arg;
+  new_intern_condition_.Broadcast(self);
+  weak_interns_.SweepWeaksInterruptibly(callback, arg);
 }
 
 std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
@@ -337,12 +386,29 @@ void InternTable::Table::VisitRoots(RootCallback* callback, void* arg) {
 }
 
 void InternTable::Table::SweepWeaks(IsMarkedCallback* callback, void* arg) {
-  SweepWeaks(&pre_zygote_table_, callback, arg);
-  SweepWeaks(&post_zygote_table_, callback, arg);
+  SweepWeaks(&pre_zygote_table_, callback, arg, false);
+  SweepWeaks(&post_zygote_table_, callback, arg, false);
+}
+
+void InternTable::Table::SweepWeaksInterruptibly(IsMarkedCallback* callback, void* arg) {
+  SweepWeaks(&pre_zygote_table_, callback, arg, true);
+  SweepWeaks(&post_zygote_table_, callback, arg, true);
 }
 
-void InternTable::Table::SweepWeaks(UnorderedSet* set, IsMarkedCallback* callback, void* arg) {
+void InternTable::Table::SweepWeaks(UnorderedSet* set, IsMarkedCallback* callback, void* arg,
+                                    bool interruptible) {
+  // Number of strings swept between giving other threads a chance to take the lock.
+  static constexpr size_t kSweepBatchSize = 1024;
+  size_t batch_count = 0;
   for (auto it = set->begin(), end = set->end(); it != end;) {
+    if (interruptible && ++batch_count == kSweepBatchSize) {
+      // The iterators stay valid since nobody else modifies the set.
+      Thread* self = Thread::Current();
+      Locks::intern_table_lock_->ExclusiveUnlock(self);
+      sched_yield();
+      Locks::intern_table_lock_->ExclusiveLock(self);
+      batch_count = 0;
+    }
     // This does not need a read barrier because this is called by GC.
     mirror::Object* object = it->Read<kWithoutReadBarrier>();
     mirror::Object* new_object = callback(object, arg);
@@ -355,6 +421,17 @@ void InternTable::Table::SweepWeaks(UnorderedSet* set, IsMarkedCallback* callbac
   }
 }
 
+void InternTable::Table::AddAll(Table* other) {
+  for (auto& intern : other->pre_zygote_table_) {
+    Insert(intern.Read());
+  }
+  for (auto& intern : other->post_zygote_table_) {
+    Insert(intern.Read());
+  }
+  other->pre_zygote_table_.Clear();
+  other->post_zygote_table_.Clear();
+}
+
 size_t InternTable::Table::Size() const {
   return pre_zygote_table_.Size() + post_zygote_table_.Size();
 }
@@ -68,8 +68,10 @@ class InternTable {
   // Interns a potentially new string in the 'weak' table. (See above.)
   mirror::String* InternWeak(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Removes the unmarked strings from the weak table. If new interns are disallowed, threads
+  // blocked in Insert may go ahead while the sweep runs, see weak_sweep_callback_.
   void SweepInternTableWeaks(IsMarkedCallback* callback, void* arg)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(Locks::intern_table_lock_);
 
   bool ContainsWeak(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
@@ -130,6 +132,14 @@ class InternTable {
     void SweepWeaks(IsMarkedCallback* callback, void* arg)
         SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
         EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
+    // Like SweepWeaks, but drops and reacquires the intern table lock every so often so that
+    // other threads can use the table. They must not modify this table in the meantime.
+    void SweepWeaksInterruptibly(IsMarkedCallback* callback, void* arg)
+        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
+    // Moves all of the strings in other into this table.
+    void AddAll(Table* other) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
     void SwapPostZygoteWithPreZygote() EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
     size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
 
@@ -137,7 +147,7 @@ class InternTable {
     typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
         TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
 
-    void SweepWeaks(UnorderedSet* set, IsMarkedCallback* callback, void* arg)
+    void SweepWeaks(UnorderedSet* set, IsMarkedCallback* callback, void* arg, bool interruptible)
         SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
         EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
 
@@ -195,6 +205,12 @@ class InternTable {
   bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
   bool allow_new_interns_ GUARDED_BY(Locks::intern_table_lock_);
   ConditionVariable new_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
+  // Set while the GC sweeps weak_interns_ with new interns disallowed. Insert does not wait for
+  // the sweep in that case. Instead it treats the unmarked weak interns as already swept and
+  // leaves weak_interns_ alone: new weak interns go to new_weak_interns_ and weak interns
+  // promoted to strong are removed from weak_interns_ by AllowNewInterns.
+  IsMarkedCallback* weak_sweep_callback_ GUARDED_BY(Locks::intern_table_lock_);
+  void* weak_sweep_arg_ GUARDED_BY(Locks::intern_table_lock_);
   // Since this contains (strong) roots, they need a read barrier to
   // enable concurrent intern table (strong) root scan. Do not
   // directly access the strings in it. Use functions that contain
@@ -206,6 +222,12 @@ class InternTable {
   // not directly access the strings in it. Use functions that contain
   // read barriers.
   Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  // Weak interns added while weak_interns_ is being swept. They are not swept in this GC since
+  // they may have been allocated after marking.
+  Table new_weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  // Weak interns promoted to strong while weak_interns_ is being swept.
+  std::vector<GcRoot<mirror::String>> promoted_weak_interns_
+      GUARDED_BY(Locks::intern_table_lock_);
 };
 
 }  // namespace art
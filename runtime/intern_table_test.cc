@@ -127,6 +127,54 @@ TEST_F(InternTableTest, SweepInternTableWeaks) {
   EXPECT_EQ(3U, t.Size());
 }
 
+static mirror::Object* IsSameObjectCallback(mirror::Object* object, void* arg) {
+  return object == arg ? object : nullptr;
+}
+
+// The GC does this in a pause.
+static void DisallowNewInterns(InternTable* t) NO_THREAD_SAFETY_ANALYSIS {
+  t->DisallowNewInterns();
+}
+
+TEST_F(InternTableTest, InternWhileSweeping) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  StackHandleScope<5> hs(soa.Self());
+  Handle<mirror::String> live(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "live")));
+  Handle<mirror::String> dead(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "dead")));
+  EXPECT_EQ(live.Get(), t.InternWeak(live.Get()));
+  EXPECT_EQ(dead.Get(), t.InternWeak(dead.Get()));
+
+  DisallowNewInterns(&t);
+  {
+    ReaderMutexLock mu(soa.Self(), *Locks::heap_bitmap_lock_);
+    t.SweepInternTableWeaks(IsSameObjectCallback, live.Get());
+  }
+  EXPECT_EQ(1U, t.Size());
+
+  // The sweep is over but new interns are still disallowed. Interning must not block.
+  Handle<mirror::String> live_copy(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "live")));
+  EXPECT_EQ(live.Get(), t.InternWeak(live_copy.Get()));
+  Handle<mirror::String> fresh(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "fresh")));
+  EXPECT_EQ(fresh.Get(), t.InternWeak(fresh.Get()));
+  Handle<mirror::String> dead_copy(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "dead")));
+  EXPECT_EQ(dead_copy.Get(), t.InternStrong(dead_copy.Get()));
+  // Promote a weak intern that was in the table before the sweep.
+  EXPECT_EQ(live.Get(), t.InternStrong(live_copy.Get()));
+
+  t.AllowNewInterns();
+  EXPECT_EQ(3U, t.Size());
+  EXPECT_EQ(1U, t.WeakSize());
+  EXPECT_TRUE(t.ContainsWeak(fresh.Get()));
+  EXPECT_FALSE(t.ContainsWeak(live.Get()));
+  EXPECT_EQ(live.Get(), t.InternWeak(live_copy.Get()));
+}
+
 TEST_F(InternTableTest, ContainsWeak) {
   ScopedObjectAccess soa(Thread::Current());
   {
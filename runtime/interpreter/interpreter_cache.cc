@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "interpreter_cache.h"
+
+#include <string.h>
+
+namespace art {
+
+void InterpreterCache::Clear() {
+  memset(entries_, 0, sizeof(entries_));
+}
+
+void InterpreterCache::VisitRoots(RootCallback* callback, void* arg, const RootInfo& root_info) {
+  for (Entry& entry : entries_) {
+    if (entry.inst == nullptr) {
+      continue;
+    }
+    if (entry.klass != nullptr) {
+      callback(reinterpret_cast<mirror::Object**>(&entry.klass), arg, root_info);
+    }
+    callback(&entry.target, arg, root_info);
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "gc_root.h"
+
+namespace art {
+namespace mirror {
+class Class;
+class Object;
+}  // namespace mirror
+
+class Instruction;
+
+// Per-thread side table of what the interpreter resolved at a dex instruction, so that running
+// the instruction again does not go back through the dex cache and method lookup. Instance field
+// accesses record the field, and virtual and interface invokes record the target for the last
+// receiver class seen (a monomorphic inline cache). Entries are keyed by the address of the
+// instruction, which is unique to one method, in a small direct-mapped table. Each thread has
+// its own table, so entries are updated without synchronization.
+class InterpreterCache {
+ public:
+  static constexpr size_t kSize = 256;  // Must be a power of 2.
+
+  struct Entry {
+    const Instruction* inst;
+    // Receiver class for invokes, null for field accesses.
+    mirror::Class* klass;
+    // The ArtMethod to invoke or the ArtField to access.
+    mirror::Object* target;
+  };
+
+  InterpreterCache() {
+    Clear();
+  }
+
+  // Returns the entry inst maps to, which holds inst only on a hit.
+  Entry* Lookup(const Instruction* inst) {
+    // Instructions are 2 byte aligned.
+    return &entries_[(reinterpret_cast<uintptr_t>(inst) >> 1) & (kSize - 1)];
+  }
+
+  void Clear();
+
+  // Classes may move, so the GC updates entries like any other root.
+  void VisitRoots(RootCallback* callback, void* arg, const RootInfo& root_info);
+
+ private:
+  Entry entries_[kSize];
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
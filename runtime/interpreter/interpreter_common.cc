@@ -26,13 +26,42 @@ void ThrowNullPointerExceptionFromInterpreter(const ShadowFrame& shadow_frame) {
   ThrowNullPointerExceptionFromDexPC(shadow_frame.GetCurrentLocationForThrow());
 }
 
+// Finds the field accessed by an iget/iput/sget/sput instruction. Instance fields of code that
+// needs no access checks are remembered in the thread's interpreter cache, so that running the
+// instruction again skips the dex cache. Static fields may still need their class initialized
+// and always take the full lookup.
+template<FindFieldType find_type, Primitive::Type field_type, bool do_access_check>
+static inline ArtField* FindFieldForInstruction(Thread* self, const ShadowFrame& shadow_frame,
+                                                const Instruction* inst, uint32_t field_idx)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  const bool is_static = (find_type == StaticObjectRead) || (find_type == StaticPrimitiveRead) ||
+      (find_type == StaticObjectWrite) || (find_type == StaticPrimitiveWrite);
+  InterpreterCache::Entry* cache_entry = nullptr;
+  if (!is_static && !do_access_check) {
+    cache_entry = self->GetInterpreterCache()->Lookup(inst);
+    if (cache_entry->inst == inst) {
+      DCHECK(cache_entry->klass == nullptr);
+      return down_cast<ArtField*>(cache_entry->target);
+    }
+  }
+  ArtField* f = FindFieldFromCode<find_type, do_access_check>(field_idx, shadow_frame.GetMethod(),
+                                                              self,
+                                                              Primitive::FieldSize(field_type));
+  if (cache_entry != nullptr && f != nullptr) {
+    cache_entry->inst = inst;
+    cache_entry->klass = nullptr;
+    cache_entry->target = f;
+  }
+  return f;
+}
+
 template<FindFieldType find_type, Primitive::Type field_type, bool do_access_check>
 bool DoFieldGet(Thread* self, ShadowFrame& shadow_frame, const Instruction* inst,
                 uint16_t inst_data) {
   const bool is_static = (find_type == StaticObjectRead) || (find_type == StaticPrimitiveRead);
   const uint32_t field_idx = is_static ? inst->VRegB_21c() : inst->VRegC_22c();
-  ArtField* f = FindFieldFromCode<find_type, do_access_check>(field_idx, shadow_frame.GetMethod(), self,
-                                                              Primitive::FieldSize(field_type));
+  ArtField* f = FindFieldForInstruction<find_type, field_type, do_access_check>(self, shadow_frame,
+                                                                                inst, field_idx);
   if (UNLIKELY(f == nullptr)) {
     CHECK(self->IsExceptionPending());
     return false;
@@ -207,8 +236,8 @@ bool DoFieldPut(Thread* self, const ShadowFrame& shadow_frame, const Instruction
   bool do_assignability_check = do_access_check;
   bool is_static = (find_type == StaticObjectWrite) || (find_type == StaticPrimitiveWrite);
   uint32_t field_idx = is_static ? inst->VRegB_21c() : inst->VRegC_22c();
-  ArtField* f = FindFieldFromCode<find_type, do_access_check>(field_idx, shadow_frame.GetMethod(), self,
-                                                              Primitive::FieldSize(field_type));
+  ArtField* f = FindFieldForInstruction<find_type, field_type, do_access_check>(self, shadow_frame,
+                                                                                inst, field_idx);
   if (UNLIKELY(f == nullptr)) {
     CHECK(self->IsExceptionPending());
     return false;
@@ -30,6 +30,7 @@
 #include "entrypoints/entrypoint_utils-inl.h"
 #include "gc/accounting/card_table-inl.h"
 #include "handle_scope-inl.h"
+#include "interpreter_cache.h"
 #include "method_helper-inl.h"
 #include "nth_caller_visitor.h"
 #include "mirror/art_field-inl.h"
@@ -108,6 +109,16 @@ static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instr
   const uint32_t method_idx = (is_range) ? inst->VRegB_3rc() : inst->VRegB_35c();
   const uint32_t vregC = (is_range) ? inst->VRegC_3rc() : inst->VRegC_35c();
   Object* receiver = (type == kStatic) ? nullptr : shadow_frame.GetVRegReference(vregC);
+  // Virtual and interface invokes in code that needs no access checks go through a monomorphic
+  // inline cache keyed by the receiver class.
+  InterpreterCache::Entry* cache_entry = nullptr;
+  if ((type == kVirtual || type == kInterface) && !do_access_check && receiver != nullptr) {
+    cache_entry = self->GetInterpreterCache()->Lookup(inst);
+    if (cache_entry->inst == inst && cache_entry->klass == receiver->GetClass()) {
+      ArtMethod* const method = down_cast<ArtMethod*>(cache_entry->target);
+      return DoCall<is_range, do_access_check>(method, self, shadow_frame, inst, inst_data, result);
+    }
+  }
   mirror::ArtMethod* sf_method = shadow_frame.GetMethod();
   ArtMethod* const method = FindMethodFromCode<type, do_access_check>(
       method_idx, &receiver, &sf_method, self);
@@ -121,6 +132,12 @@ static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instr
     result->SetJ(0);
     return false;
   } else {
+    if (cache_entry != nullptr) {
+      // Resolution may have moved the receiver, so read its class again.
+      cache_entry->inst = inst;
+      cache_entry->klass = receiver->GetClass();
+      cache_entry->target = method;
+    }
     return DoCall<is_range, do_access_check>(method, self, shadow_frame, inst, inst_data, result);
   }
 }
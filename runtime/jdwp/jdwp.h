@@ -265,6 +265,8 @@ struct JdwpState {
       LOCKS_EXCLUDED(event_list_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  bool IsConnected();
+
   /* atomic ops to get next serial number */
   uint32_t NextRequestSerial();
   uint32_t NextEventSerial();
@@ -301,7 +303,6 @@ struct JdwpState {
   explicit JdwpState(const JdwpOptions* options);
   size_t ProcessRequest(Request& request, ExpandBuf* pReply);
   bool InvokeInProgress();
-  bool IsConnected();
   void SuspendByPolicy(JdwpSuspendPolicy suspend_policy, JDWP::ObjectId thread_self_id)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
   void SendRequestAndPossiblySuspend(ExpandBuf* pReq, JdwpSuspendPolicy suspend_policy,
@@ -71,6 +71,14 @@ class JdwpNetStateBase {
 
   ssize_t WritePacket(ExpandBuf* pReply, size_t length) LOCKS_EXCLUDED(socket_lock_);
   ssize_t WriteBufferedPacket(const std::vector<iovec>& iov) LOCKS_EXCLUDED(socket_lock_);
+  // Like WriteBufferedPacket, for callers that hold the socket lock to send one packet in several
+  // writes.
+  ssize_t WriteBufferedPacketLocked(const std::vector<iovec>& iov)
+      EXCLUSIVE_LOCKS_REQUIRED(socket_lock_);
+
+  Mutex* GetSocketLock() LOCK_RETURNED(socket_lock_) {
+    return &socket_lock_;
+  }
 
   int clientSock;  // Active connection to debugger.
 
@@ -61,7 +61,7 @@ static const size_t kMonitorsInitial = 32;  // Arbitrary.
 static const size_t kMonitorsMax = 4096;  // Arbitrary sanity check.
 
 static const size_t kLocalsInitial = 64;  // Arbitrary.
-static const size_t kLocalsMax = 512;  // Arbitrary sanity check.
+static const size_t kLocalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
 
 static size_t gGlobalsInitial = 512;  // Arbitrary.
 static size_t gGlobalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
@@ -2561,7 +2561,7 @@ class JNI {
  private:
   static jint EnsureLocalCapacity(ScopedObjectAccess& soa, jint desired_capacity,
                                   const char* caller) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
-    // TODO: we should try to expand the table if necessary.
+    // The table expands as needed up to kLocalsMax.
     if (desired_capacity < 0 || desired_capacity > static_cast<jint>(kLocalsMax)) {
       LOG(ERROR) << "Invalid capacity given to " << caller << ": " << desired_capacity;
       return JNI_ERR;
@@ -1412,8 +1412,8 @@ TEST_F(JniInternalTest, PushLocalFrame_10395422) {
   // Negative capacities are not allowed.
   ASSERT_EQ(JNI_ERR, env_->PushLocalFrame(-1));
 
-  // And it's okay to have an upper limit. Ours is currently 512.
-  ASSERT_EQ(JNI_ERR, env_->PushLocalFrame(8192));
+  // And it's okay to have an upper limit. Ours is currently 51200.
+  ASSERT_EQ(JNI_ERR, env_->PushLocalFrame(65536));
 }
 
 TEST_F(JniInternalTest, PushLocalFrame_PopLocalFrame) {
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mapping_table_index.h"
+
+#include <algorithm>
+
+#include "mapping_table.h"
+#include "thread-inl.h"
+
+namespace art {
+
+MappingTableIndex::MappingTableIndex()
+    : lock_("Mapping table index lock", kMappingTableIndexLock) {
+}
+
+bool MappingTableIndex::FindDexPc(const uint8_t* encoded_table, uint32_t native_pc_offset,
+                                  uint32_t* dex_pc) {
+  MappingTable table(encoded_table);
+  if (table.TotalSize() < kMinEntriesToIndex) {
+    return FindDexPcLinear(encoded_table, native_pc_offset, dex_pc);
+  }
+  const Index* index = GetOrCreateIndex(encoded_table);
+  auto it = std::lower_bound(index->begin(), index->end(), native_pc_offset,
+                             [](const Entry& entry, uint32_t offset) {
+                               return entry.native_pc_offset < offset;
+                             });
+  if (it == index->end() || it->native_pc_offset != native_pc_offset) {
+    return false;
+  }
+  *dex_pc = it->dex_pc;
+  return true;
+}
+
+size_t MappingTableIndex::Size() {
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  return indices_.size();
+}
+
+bool MappingTableIndex::FindDexPcLinear(const uint8_t* encoded_table, uint32_t native_pc_offset,
+                                        uint32_t* dex_pc) {
+  MappingTable table(encoded_table);
+  typedef MappingTable::PcToDexIterator It;
+  for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
+    if (cur.NativePcOffset() == native_pc_offset) {
+      *dex_pc = cur.DexPc();
+      return true;
+    }
+  }
+  typedef MappingTable::DexToPcIterator It2;
+  for (It2 cur = table.DexToPcBegin(), end = table.DexToPcEnd(); cur != end; ++cur) {
+    if (cur.NativePcOffset() == native_pc_offset) {
+      *dex_pc = cur.DexPc();
+      return true;
+    }
+  }
+  return false;
+}
+
+void MappingTableIndex::BuildIndex(const uint8_t* encoded_table, Index* index) {
+  MappingTable table(encoded_table);
+  index->reserve(table.TotalSize());
+  typedef MappingTable::PcToDexIterator It;
+  for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
+    index->push_back(Entry { cur.NativePcOffset(), cur.DexPc() });
+  }
+  typedef MappingTable::DexToPcIterator It2;
+  for (It2 cur = table.DexToPcBegin(), end = table.DexToPcEnd(); cur != end; ++cur) {
+    index->push_back(Entry { cur.NativePcOffset(), cur.DexPc() });
+  }
+  // Keep the first entry for each native pc offset, so that pc-to-dex entries win over
+  // dex-to-pc entries and earlier entries win over later ones, as in the linear lookup.
+  auto by_offset = [](const Entry& lhs, const Entry& rhs) {
+    return lhs.native_pc_offset < rhs.native_pc_offset;
+  };
+  std::stable_sort(index->begin(), index->end(), by_offset);
+  auto last = std::unique(index->begin(), index->end(), [](const Entry& lhs, const Entry& rhs) {
+    return lhs.native_pc_offset == rhs.native_pc_offset;
+  });
+  index->erase(last, index->end());
+}
+
+const MappingTableIndex::Index* MappingTableIndex::GetOrCreateIndex(
+    const uint8_t* encoded_table) {
+  Thread* self = Thread::Current();
+  {
+    ReaderMutexLock mu(self, lock_);
+    auto it = indices_.find(encoded_table);
+    if (it != indices_.end()) {
+      return &it->second;
+    }
+  }
+  // Build outside the lock; if another thread got there first, its index is used instead.
+  Index index;
+  BuildIndex(encoded_table, &index);
+  WriterMutexLock mu(self, lock_);
+  auto it = indices_.lower_bound(encoded_table);
+  if (it == indices_.end() || it->first != encoded_table) {
+    it = indices_.PutBefore(it, encoded_table, Index());
+    it->second.swap(index);
+  }
+  // Entries are never removed, so the index stays valid after the lock is released.
+  return &it->second;
+}
+
+}  // namespace art
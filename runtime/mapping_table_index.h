@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ART_RUNTIME_MAPPING_TABLE_INDEX_H_
+#define ART_RUNTIME_MAPPING_TABLE_INDEX_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "safe_map.h"
+
+namespace art {
+
+// Native pc to dex pc lookup for the uleb128 encoded mapping tables of quick code. Decoding a
+// table walks all of its entries, so large tables get a sorted fixed-width copy of their
+// entries on first use, which is then binary searched. Mapping tables are deduplicated and
+// never unmapped while the runtime lives, so the copies are keyed by table address.
+class MappingTableIndex {
+ public:
+  // Tables with fewer entries are scanned in place; building a copy does not pay off.
+  static constexpr size_t kMinEntriesToIndex = 16;
+
+  MappingTableIndex();
+
+  // Looks up native_pc_offset in the pc-to-dex entries of encoded_table, then in its
+  // dex-to-pc entries, and stores the matching dex pc. Returns false if there is none.
+  bool FindDexPc(const uint8_t* encoded_table, uint32_t native_pc_offset, uint32_t* dex_pc)
+      LOCKS_EXCLUDED(lock_);
+
+  // Number of tables that have an index, for tests.
+  size_t Size() LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Entry {
+    uint32_t native_pc_offset;
+    uint32_t dex_pc;
+  };
+  typedef std::vector<Entry> Index;
+
+  static bool FindDexPcLinear(const uint8_t* encoded_table, uint32_t native_pc_offset,
+                              uint32_t* dex_pc);
+  static void BuildIndex(const uint8_t* encoded_table, Index* index);
+
+  const Index* GetOrCreateIndex(const uint8_t* encoded_table) LOCKS_EXCLUDED(lock_);
+
+  ReaderWriterMutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  SafeMap<const uint8_t*, Index> indices_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(MappingTableIndex);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_MAPPING_TABLE_INDEX_H_
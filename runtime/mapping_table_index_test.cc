@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mapping_table_index.h"
+
+#include "common_runtime_test.h"
+#include "leb128.h"
+
+namespace art {
+
+class MappingTableIndexTest : public CommonRuntimeTest {};
+
+// Encodes a mapping table the way the quick compiler does: a header with the total number of
+// entries and the number of pc-to-dex entries, then delta encoded pc-to-dex entries, then
+// delta encoded dex-to-pc entries.
+static std::vector<uint8_t> EncodeMappingTable(
+    const std::vector<std::pair<uint32_t, uint32_t>>& pc_to_dex,
+    const std::vector<std::pair<uint32_t, uint32_t>>& dex_to_pc) {
+  Leb128EncodingVector encoder;
+  encoder.PushBackUnsigned(pc_to_dex.size() + dex_to_pc.size());
+  encoder.PushBackUnsigned(pc_to_dex.size());
+  for (const auto* entries : { &pc_to_dex, &dex_to_pc }) {
+    uint32_t native_pc_offset = 0u;
+    int32_t dex_pc = 0;
+    for (const auto& entry : *entries) {
+      encoder.PushBackUnsigned(entry.first - native_pc_offset);
+      encoder.PushBackSigned(static_cast<int32_t>(entry.second) - dex_pc);
+      native_pc_offset = entry.first;
+      dex_pc = entry.second;
+    }
+  }
+  return encoder.GetData();
+}
+
+TEST_F(MappingTableIndexTest, SmallTableIsNotIndexed) {
+  MappingTableIndex index;
+  std::vector<uint8_t> table = EncodeMappingTable({ {4u, 1u}, {8u, 3u} }, { {12u, 7u} });
+  uint32_t dex_pc;
+  ASSERT_TRUE(index.FindDexPc(&table[0], 8u, &dex_pc));
+  EXPECT_EQ(3u, dex_pc);
+  ASSERT_TRUE(index.FindDexPc(&table[0], 12u, &dex_pc));
+  EXPECT_EQ(7u, dex_pc);
+  EXPECT_FALSE(index.FindDexPc(&table[0], 5u, &dex_pc));
+  EXPECT_EQ(0u, index.Size());
+}
+
+TEST_F(MappingTableIndexTest, LargeTable) {
+  MappingTableIndex index;
+  std::vector<std::pair<uint32_t, uint32_t>> pc_to_dex;
+  for (uint32_t i = 0; i < 4 * MappingTableIndex::kMinEntriesToIndex; ++i) {
+    // Dex pcs do not grow with native pcs, which needs negative deltas.
+    pc_to_dex.push_back(std::make_pair(10u * (i + 1u), (i * 7u) % 50u));
+  }
+  // A catch entry at a native pc offset that is also a suspend point: the pc-to-dex entry wins.
+  std::vector<std::pair<uint32_t, uint32_t>> dex_to_pc = { {3u, 100u}, {20u, 101u}, {1000u, 102u} };
+  std::vector<uint8_t> table = EncodeMappingTable(pc_to_dex, dex_to_pc);
+
+  uint32_t dex_pc;
+  for (const auto& entry : pc_to_dex) {
+    ASSERT_TRUE(index.FindDexPc(&table[0], entry.first, &dex_pc));
+    EXPECT_EQ(entry.second, dex_pc);
+  }
+  ASSERT_TRUE(index.FindDexPc(&table[0], 3u, &dex_pc));
+  EXPECT_EQ(100u, dex_pc);
+  ASSERT_TRUE(index.FindDexPc(&table[0], 1000u, &dex_pc));
+  EXPECT_EQ(102u, dex_pc);
+  EXPECT_FALSE(index.FindDexPc(&table[0], 0u, &dex_pc));
+  EXPECT_FALSE(index.FindDexPc(&table[0], 11u, &dex_pc));
+  EXPECT_FALSE(index.FindDexPc(&table[0], 2000u, &dex_pc));
+  // All lookups share one index.
+  EXPECT_EQ(1u, index.Size());
+}
+
+}  // namespace art
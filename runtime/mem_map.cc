@@ -128,6 +128,26 @@ static uintptr_t GenerateNextMemPos() {
 
 // Initialize linear scan to random position.
 uintptr_t MemMap::next_mem_pos_ = GenerateNextMemPos();
+
+uintptr_t MemMap::SkipMemMaps(uintptr_t ptr, size_t byte_count) {
+  // Find the first map that starts above ptr. The map before it may still cover ptr.
+  auto it = maps_->upper_bound(reinterpret_cast<void*>(ptr));
+  if (it != maps_->begin()) {
+    auto before_it = it;
+    --before_it;
+    ptr = std::max(ptr, reinterpret_cast<uintptr_t>(before_it->second->BaseEnd()));
+  }
+  // Move past maps until the gap before the next one is large enough.
+  for (; it != maps_->end(); ++it) {
+    uintptr_t next_begin = reinterpret_cast<uintptr_t>(it->first);
+    if (next_begin >= ptr && next_begin - ptr >= byte_count) {
+      break;
+    }
+    ptr = std::max(ptr, reinterpret_cast<uintptr_t>(it->second->BaseEnd()));
+  }
+  DCHECK_ALIGNED(ptr, kPageSize);
+  return ptr;
+}
 #endif
 
 #if !defined(__APPLE__)  // TODO: Reanable after b/16861075 BacktraceMap issue is addressed.
@@ -288,18 +308,18 @@ MemMap* MemMap::MapAnonymous(const char* name, byte* expected_ptr, size_t byte_c
   }
 #endif
 
-  // TODO:
-  // A page allocator would be a useful abstraction here, as
-  // 1) It is doubtful that MAP_32BIT on x86_64 is doing the right job for us
-  // 2) The linear scheme, even with simple saving of the last known position, is very crude
 #if USE_ART_LOW_4G_ALLOCATOR
   // MAP_32BIT only available on x86_64.
   void* actual = MAP_FAILED;
   if (low_4gb && expected_ptr == nullptr) {
     bool first_run = true;
 
+    // The ranges taken by our own maps are known from maps_, so they are skipped without
+    // touching them. Only the gaps between them are probed for mappings made by others.
+    MutexLock mu(Thread::Current(), *Locks::mem_maps_lock_);
     for (uintptr_t ptr = next_mem_pos_; ptr < 4 * GB; ptr += kPageSize) {
-      if (4U * GB - ptr < page_aligned_byte_count) {
+      ptr = SkipMemMaps(ptr, page_aligned_byte_count);
+      if (ptr >= 4 * GB || 4U * GB - ptr < page_aligned_byte_count) {
         // Not enough memory until 4GB.
         if (first_run) {
           // Try another time from the bottom;
@@ -460,6 +480,14 @@ MemMap::~MemMap() {
 
   // Remove it from maps_.
   MutexLock mu(Thread::Current(), *Locks::mem_maps_lock_);
+#if USE_ART_LOW_4G_ALLOCATOR
+  // Let the next low_4gb search start at the range we just released, so that it is reused
+  // before the scan wraps around.
+  uintptr_t base = reinterpret_cast<uintptr_t>(base_begin_);
+  if (!reuse_ && base >= LOW_MEM_START && base < next_mem_pos_) {
+    next_mem_pos_ = base;
+  }
+#endif
   bool found = false;
   DCHECK(maps_ != nullptr);
   for (auto it = maps_->lower_bound(base_begin_), end = maps_->end();
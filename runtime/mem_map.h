@@ -166,7 +166,13 @@ class MemMap {
   const bool reuse_;
 
 #if USE_ART_LOW_4G_ALLOCATOR
-  static uintptr_t next_mem_pos_;   // Next memory location to check for low_4g extent.
+  // Returns the first page aligned address at or after ptr such that byte_count bytes from it
+  // do not overlap any of maps_. The result may be at or above 4GB.
+  static uintptr_t SkipMemMaps(uintptr_t ptr, size_t byte_count)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mem_maps_lock_);
+
+  // Next memory location to check for low_4g extent.
+  static uintptr_t next_mem_pos_ GUARDED_BY(Locks::mem_maps_lock_);
 #endif
 
   // All the non-empty MemMaps. Use a multimap as we do a reserve-and-divide (eg ElfMap::Load()).
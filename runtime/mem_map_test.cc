@@ -19,6 +19,7 @@
 #include <memory>
 
 #include "gtest/gtest.h"
+#include "thread.h"
 
 namespace art {
 
@@ -91,6 +92,7 @@ class MemMapTest : public testing::Test {
 
 #if defined(__LP64__) && !defined(__x86_64__)
   static uintptr_t GetLinearScanPos() {
+    MutexLock mu(Thread::Current(), *Locks::mem_maps_lock_);
     return MemMap::next_mem_pos_;
   }
 #endif
@@ -121,6 +123,37 @@ TEST_F(MemMapTest, Start) {
 #endif
   // End of test.
 }
+
+TEST_F(MemMapTest, MapAnonymousLow4GBReusesReleasedRange) {
+  CommonInit();
+  std::string error_msg;
+  constexpr size_t kMapSize = 16 * kPageSize;
+  std::unique_ptr<MemMap> map0(MemMap::MapAnonymous("MapAnonymousLow4GB0",
+                                                    nullptr,
+                                                    kMapSize,
+                                                    PROT_READ | PROT_WRITE,
+                                                    true,
+                                                    &error_msg));
+  ASSERT_TRUE(map0.get() != nullptr) << error_msg;
+  uintptr_t base0 = reinterpret_cast<uintptr_t>(map0->BaseBegin());
+  EXPECT_LT(base0 + kMapSize, 4 * GB);
+
+  // The second map skips over the first one.
+  std::unique_ptr<MemMap> map1(MemMap::MapAnonymous("MapAnonymousLow4GB1",
+                                                    nullptr,
+                                                    kMapSize,
+                                                    PROT_READ | PROT_WRITE,
+                                                    true,
+                                                    &error_msg));
+  ASSERT_TRUE(map1.get() != nullptr) << error_msg;
+  uintptr_t base1 = reinterpret_cast<uintptr_t>(map1->BaseBegin());
+  EXPECT_LT(base1 + kMapSize, 4 * GB);
+  EXPECT_TRUE(base1 >= base0 + kMapSize || base1 + kMapSize <= base0);
+
+  // Releasing the first map makes the next search start at its range.
+  map0.reset();
+  EXPECT_LE(GetLinearScanPos(), base0);
+}
 #endif
 
 TEST_F(MemMapTest, MapAnonymousEmpty) {
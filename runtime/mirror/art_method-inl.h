@@ -304,6 +304,21 @@ inline const uint8_t* ArtMethod::GetNativeGcMap(const void* code_pointer, size_t
   return reinterpret_cast<const uint8_t*>(code_pointer) - offset;
 }
 
+inline bool ArtMethod::IsOptimized(size_t pointer_size) {
+  // Temporary solution for detecting if a method has been optimized: the compiler
+  // does not create a GC map. Instead, the vmap table contains the stack map
+  // (as in stack_map.h).
+  return !IsNative()
+      && GetQuickOatCodePointer(pointer_size) != nullptr
+      && GetNativeGcMap(pointer_size) == nullptr;
+}
+
+inline CodeInfo<uint32_t> ArtMethod::GetOptimizedCodeInfo() {
+  DCHECK(IsOptimized(sizeof(void*)));
+  const void* code_pointer = GetQuickOatCodePointer(sizeof(void*));
+  return CodeInfo<uint32_t>(GetVmapTable(code_pointer, sizeof(void*)));
+}
+
 inline bool ArtMethod::IsRuntimeMethod() {
   return GetDexMethodIndex() == DexFile::kDexNoIndex;
 }
@@ -27,6 +27,7 @@
 #include "interpreter/interpreter.h"
 #include "jni_internal.h"
 #include "mapping_table.h"
+#include "mapping_table_index.h"
 #include "method_helper-inl.h"
 #include "object_array-inl.h"
 #include "object_array.h"
@@ -151,28 +152,34 @@ uint32_t ArtMethod::ToDexPc(const uintptr_t pc, bool abort_on_failure) {
     return static_cast<uint32_t>(pc);
   }
   const void* entry_point = GetQuickOatEntryPoint(sizeof(void*));
-  MappingTable table(entry_point != nullptr ?
-      GetMappingTable(EntryPointToCodePointer(entry_point), sizeof(void*)) : nullptr);
+  uint32_t sought_offset = pc - reinterpret_cast<uintptr_t>(entry_point);
+  if (IsOptimized(sizeof(void*))) {
+    CodeInfo<uint32_t> code_info = GetOptimizedCodeInfo();
+    size_t index = code_info.FindStackMapIndexForNativePc(sought_offset);
+    if (index != CodeInfo<uint32_t>::kNoStackMap) {
+      return code_info.GetStackMapAt(index).GetDexPc();
+    }
+    if (abort_on_failure) {
+      LOG(FATAL) << "Failed to find Dex offset for PC offset "
+                 << reinterpret_cast<void*>(sought_offset) << "(PC " << reinterpret_cast<void*>(pc)
+                 << ", entry_point=" << entry_point << ") in optimized " << PrettyMethod(this);
+    }
+    return DexFile::kDexNoIndex;
+  }
+  const uint8_t* mapping_table = entry_point != nullptr ?
+      GetMappingTable(EntryPointToCodePointer(entry_point), sizeof(void*)) : nullptr;
+  MappingTable table(mapping_table);
   if (table.TotalSize() == 0) {
     // NOTE: Special methods (see Mir2Lir::GenSpecialCase()) have an empty mapping
     // but they have no suspend checks and, consequently, we never call ToDexPc() for them.
     DCHECK(IsNative() || IsCalleeSaveMethod() || IsProxyMethod()) << PrettyMethod(this);
     return DexFile::kDexNoIndex;   // Special no mapping case
   }
-  uint32_t sought_offset = pc - reinterpret_cast<uintptr_t>(entry_point);
-  // Assume the caller wants a pc-to-dex mapping so check here first.
-  typedef MappingTable::PcToDexIterator It;
-  for (It cur = table.PcToDexBegin(), end = table.PcToDexEnd(); cur != end; ++cur) {
-    if (cur.NativePcOffset() == sought_offset) {
-      return cur.DexPc();
-    }
-  }
-  // Now check dex-to-pc mappings.
-  typedef MappingTable::DexToPcIterator It2;
-  for (It2 cur = table.DexToPcBegin(), end = table.DexToPcEnd(); cur != end; ++cur) {
-    if (cur.NativePcOffset() == sought_offset) {
-      return cur.DexPc();
-    }
+  // Pc-to-dex entries take precedence over dex-to-pc (catch entry) ones.
+  uint32_t dex_pc;
+  if (Runtime::Current()->GetMappingTableIndex()->FindDexPc(mapping_table, sought_offset,
+                                                            &dex_pc)) {
+    return dex_pc;
   }
   if (abort_on_failure) {
       LOG(FATAL) << "Failed to find Dex offset for PC offset " << reinterpret_cast<void*>(sought_offset)
@@ -184,6 +191,17 @@ uint32_t ArtMethod::ToDexPc(const uintptr_t pc, bool abort_on_failure) {
 
 uintptr_t ArtMethod::ToNativePc(const uint32_t dex_pc) {
   const void* entry_point = GetQuickOatEntryPoint(sizeof(void*));
+  if (IsOptimized(sizeof(void*))) {
+    CodeInfo<uint32_t> code_info = GetOptimizedCodeInfo();
+    size_t index = code_info.FindStackMapIndexForDexPc(dex_pc);
+    if (index != CodeInfo<uint32_t>::kNoStackMap) {
+      uint32_t native_pc_offset = code_info.GetStackMapAt(index).GetNativePc();
+      return reinterpret_cast<uintptr_t>(entry_point) + native_pc_offset;
+    }
+    LOG(FATAL) << "Failed to find native offset for dex pc 0x" << std::hex << dex_pc
+               << " in optimized " << PrettyMethod(this);
+    return 0;
+  }
   MappingTable table(entry_point != nullptr ?
       GetMappingTable(EntryPointToCodePointer(entry_point), sizeof(void*)) : nullptr);
   if (table.TotalSize() == 0) {
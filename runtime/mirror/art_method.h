@@ -26,6 +26,7 @@
 #include "quick/quick_method_frame_info.h"
 #include "read_barrier_option.h"
 #include "stack.h"
+#include "stack_map.h"
 
 namespace art {
 
@@ -129,6 +130,13 @@ class MANAGED ArtMethod FINAL : public Object {
     return (GetAccessFlags() & mask) == mask;
   }
 
+  // A static native with a primitive-only signature that is called without a JNIEnv*, jclass
+  // or thread state transition. See DexFile::IsCriticalNativeMethod.
+  bool IsCriticalNative() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    uint32_t mask = kAccCriticalNative | kAccNative;
+    return (GetAccessFlags() & mask) == mask;
+  }
+
   bool IsAbstract() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     return (GetAccessFlags() & kAccAbstract) != 0;
   }
@@ -385,6 +393,11 @@ class MANAGED ArtMethod FINAL : public Object {
   const uint8_t* GetNativeGcMap(const void* code_pointer, size_t pointer_size)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Code from the optimizing compiler has no native GC map or mapping table; its stack maps
+  // are a CodeInfo stored in place of the vmap table.
+  bool IsOptimized(size_t pointer_size) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  CodeInfo<uint32_t> GetOptimizedCodeInfo() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   template <bool kCheckFrameSize = true>
   uint32_t GetFrameSizeInBytes() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     uint32_t result = GetQuickFrameInfo().FrameSizeInBytes();
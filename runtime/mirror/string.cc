@@ -16,6 +16,7 @@
 
 #include "string-inl.h"
 
+#include "arch/memchr16.h"
 #include "arch/memcmp16.h"
 #include "array.h"
 #include "class-inl.h"
@@ -41,14 +42,8 @@ int32_t String::FastIndexOf(int32_t ch, int32_t start) {
     start = count;
   }
   const uint16_t* chars = GetCharArray()->GetData() + GetOffset();
-  const uint16_t* p = chars + start;
-  const uint16_t* end = chars + count;
-  while (p < end) {
-    if (*p++ == ch) {
-      return (p - 1) - chars;
-    }
-  }
-  return -1;
+  int32_t index = MemChr16(chars + start, static_cast<uint16_t>(ch), count - start);
+  return (index < 0) ? -1 : start + index;
 }
 
 void String::SetClass(Class* java_lang_String) {
@@ -146,12 +141,9 @@ bool String::Equals(String* that) {
   } else {
     // Note: don't short circuit on hash code as we're presumably here as the
     // hash code was already equal
-    for (int32_t i = 0; i < that->GetLength(); ++i) {
-      if (this->CharAt(i) != that->CharAt(i)) {
-        return false;
-      }
-    }
-    return true;
+    const uint16_t* this_chars = GetCharArray()->GetData() + GetOffset();
+    const uint16_t* that_chars = that->GetCharArray()->GetData() + that->GetOffset();
+    return MemCmp16(this_chars, that_chars, that->GetLength()) == 0;
   }
 }
 
@@ -24,6 +24,7 @@
 #include "object_array.h"
 #include "object_array-inl.h"
 #include "stack_trace_element.h"
+#include "thread.h"
 #include "utils.h"
 #include "well_known_classes.h"
 
@@ -89,7 +90,7 @@ std::string Throwable::Dump() {
     } else {
       for (int32_t i = 0; i < depth; ++i) {
         mirror::ArtMethod* method = down_cast<ArtMethod*>(method_trace->Get(i));
-        uint32_t dex_pc = pc_trace->Get(i);
+        uint32_t dex_pc = Thread::InternalStackTraceDexPc(method, pc_trace->Get(i));
         int32_t line_number = method->GetLineNumFromDexPC(dex_pc);
         const char* source_file = method->GetDeclaringClassSourceFile();
         result += StringPrintf("  at %s (%s:%d)\n", PrettyMethod(method, true).c_str(),
@@ -22,6 +22,7 @@
 
 #include "base/stringpiece.h"
 #include "debugger.h"
+#include "gc/allocation_sampler.h"
 #include "gc/heap.h"
 #include "monitor.h"
 #include "runtime.h"
@@ -269,6 +270,10 @@ bool ParsedOptions::Parse(const RuntimeOptions& options, bool ignore_unrecognize
   method_trace_file_ = "/data/method-trace-file.bin";
   method_trace_file_size_ = 10 * MB;
 
+  perf_map_ = false;
+
+  alloc_sample_interval_ = gc::AllocationSampler::kDefaultInterval;
+
   profile_clock_source_ = kDefaultTraceClockSource;
 
   verify_ = true;
@@ -544,6 +549,19 @@ bool ParsedOptions::Parse(const RuntimeOptions& options, bool ignore_unrecognize
       hook_abort_ = reinterpret_cast<void(*)()>(const_cast<void*>(hook));
     } else if (option == "-Xmethod-trace") {
       method_trace_ = true;
+    } else if (option == "-Xperf-map") {
+      perf_map_ = true;
+    } else if (StartsWith(option, "-Xalloc-sample-file:")) {
+      if (!ParseStringAfterChar(option, ':', &alloc_sample_file_)) {
+        return false;
+      }
+    } else if (StartsWith(option, "-Xalloc-sample-interval:")) {
+      size_t size = ParseMemoryOption(option.substr(strlen("-Xalloc-sample-interval:")).c_str(), 1);
+      if (size == 0) {
+        Usage("Failed to parse memory option %s\n", option.c_str());
+        return false;
+      }
+      alloc_sample_interval_ = size;
     } else if (StartsWith(option, "-Xmethod-trace-file:")) {
       method_trace_file_ = option.substr(strlen("-Xmethod-trace-file:"));
     } else if (StartsWith(option, "-Xmethod-trace-file-size:")) {
@@ -793,6 +811,9 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xmethod-trace\n");
   UsageMessage(stream, "  -Xmethod-trace-file:filename");
   UsageMessage(stream, "  -Xmethod-trace-file-size:integervalue\n");
+  UsageMessage(stream, "  -Xperf-map\n");
+  UsageMessage(stream, "  -Xalloc-sample-file:filename\n");
+  UsageMessage(stream, "  -Xalloc-sample-interval:<bytes>\n");
   UsageMessage(stream, "  -Xenable-profiler\n");
   UsageMessage(stream, "  -Xprofile-filename:filename\n");
   UsageMessage(stream, "  -Xprofile-period:integervalue\n");
@@ -83,6 +83,10 @@ class ParsedOptions {
   unsigned int lock_profiling_threshold_;
   std::string stack_trace_file_;
   bool method_trace_;
+  bool perf_map_;
+  // Allocations are sampled if the file is not empty.
+  std::string alloc_sample_file_;
+  size_t alloc_sample_interval_;
   std::string method_trace_file_;
   unsigned int method_trace_file_size_;
   bool (*hook_is_sensitive_thread_)();
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "perf_map.h"
+
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
+#include "dex_file-inl.h"
+#include "mirror/art_method.h"
+#include "oat.h"
+#include "oat_file-inl.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+
+PerfMap* PerfMap::Create(const std::string& directory, std::string* error_msg) {
+  std::string filename = StringPrintf("%s/perf-%d.map", directory.c_str(), getpid());
+  File* file = OS::CreateEmptyFile(filename.c_str());
+  if (file == nullptr) {
+    *error_msg = StringPrintf("Failed to create perf map %s: %s", filename.c_str(),
+                              strerror(errno));
+    return nullptr;
+  }
+  return new PerfMap(file);
+}
+
+PerfMap::PerfMap(File* file) : lock_("perf map lock"), file_(file) {
+}
+
+PerfMap::~PerfMap() {
+  MutexLock mu(Thread::Current(), lock_);
+  if (file_->FlushClose() != 0) {
+    PLOG(WARNING) << "Failed to close perf map " << file_->GetPath();
+  }
+}
+
+static void AppendLine(const void* code, size_t size, const std::string& name,
+                       std::string* lines) {
+  StringAppendF(lines, "%" PRIxPTR " %zx %s\n",
+                reinterpret_cast<uintptr_t>(mirror::ArtMethod::EntryPointToCodePointer(code)),
+                size, name.c_str());
+}
+
+static void AddTrampoline(const OatFile& oat_file, uint32_t offset, const char* name,
+                          std::vector<std::pair<const byte*, const char*>>* trampolines) {
+  if (offset != 0) {
+    trampolines->push_back(std::make_pair(oat_file.Begin() + offset, name));
+  }
+}
+
+void PerfMap::AddOatFile(const OatFile& oat_file) {
+  if (!oat_file.IsExecutable()) {
+    return;
+  }
+  std::string lines;
+  const byte* code_begin = oat_file.End();
+  for (const OatFile::OatDexFile* oat_dex_file : oat_file.GetOatDexFiles()) {
+    std::string error_msg;
+    std::unique_ptr<const DexFile> dex_file(oat_dex_file->OpenDexFile(&error_msg));
+    if (dex_file.get() == nullptr) {
+      LOG(WARNING) << "Not adding " << oat_dex_file->GetDexFileLocation() << " to perf map: "
+                   << error_msg;
+      continue;
+    }
+    for (size_t class_def_index = 0; class_def_index < dex_file->NumClassDefs();
+         ++class_def_index) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+      const byte* class_data = dex_file->GetClassData(class_def);
+      if (class_data == nullptr) {
+        continue;
+      }
+      const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(class_def_index);
+      ClassDataItemIterator it(*dex_file, class_data);
+      while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+        it.Next();
+      }
+      // Oat methods are indexed by their position in the class data, direct methods first.
+      for (uint32_t class_method_index = 0; it.HasNext(); ++class_method_index, it.Next()) {
+        const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+        const void* code = oat_method.GetQuickCode();
+        if (code == nullptr) {
+          continue;
+        }
+        code_begin = std::min(code_begin, reinterpret_cast<const byte*>(code));
+        AppendLine(code, oat_method.GetQuickCodeSize(),
+                   PrettyMethod(it.GetMemberIndex(), *dex_file, true), &lines);
+      }
+    }
+  }
+
+  // Only the boot oat file has trampolines. They are laid out back to back ahead of the methods
+  // and their sizes are not recorded, so each one is taken to extend to the next.
+  const OatHeader& header = oat_file.GetOatHeader();
+  std::vector<std::pair<const byte*, const char*>> trampolines;
+  AddTrampoline(oat_file, header.GetInterpreterToInterpreterBridgeOffset(),
+                "art_interpreter_to_interpreter_bridge", &trampolines);
+  AddTrampoline(oat_file, header.GetInterpreterToCompiledCodeBridgeOffset(),
+                "art_interpreter_to_compiled_code_bridge", &trampolines);
+  AddTrampoline(oat_file, header.GetJniDlsymLookupOffset(), "art_jni_dlsym_lookup", &trampolines);
+  AddTrampoline(oat_file, header.GetPortableImtConflictTrampolineOffset(),
+                "art_portable_imt_conflict_trampoline", &trampolines);
+  AddTrampoline(oat_file, header.GetPortableResolutionTrampolineOffset(),
+                "art_portable_resolution_trampoline", &trampolines);
+  AddTrampoline(oat_file, header.GetPortableToInterpreterBridgeOffset(),
+                "art_portable_to_interpreter_bridge", &trampolines);
+  AddTrampoline(oat_file, header.GetQuickGenericJniTrampolineOffset(),
+                "art_quick_generic_jni_trampoline", &trampolines);
+  AddTrampoline(oat_file, header.GetQuickImtConflictTrampolineOffset(),
+                "art_quick_imt_conflict_trampoline", &trampolines);
+  AddTrampoline(oat_file, header.GetQuickResolutionTrampolineOffset(),
+                "art_quick_resolution_trampoline", &trampolines);
+  AddTrampoline(oat_file, header.GetQuickToInterpreterBridgeOffset(),
+                "art_quick_to_interpreter_bridge", &trampolines);
+  std::sort(trampolines.begin(), trampolines.end());
+  for (size_t i = 0; i < trampolines.size(); ++i) {
+    const byte* end = (i + 1 < trampolines.size()) ? trampolines[i + 1].first : code_begin;
+    if (end > trampolines[i].first) {
+      AppendLine(trampolines[i].first, end - trampolines[i].first, trampolines[i].second, &lines);
+    }
+  }
+  Write(lines);
+}
+
+void PerfMap::Write(const std::string& lines) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (!file_->WriteFully(lines.data(), lines.size())) {
+    PLOG(WARNING) << "Failed to write to perf map " << file_->GetPath();
+  }
+}
+
+}  // namespace art
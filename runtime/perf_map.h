@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_PERF_MAP_H_
+#define ART_RUNTIME_PERF_MAP_H_
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "os.h"
+
+namespace art {
+
+class OatFile;
+
+// Writes /tmp/perf-<pid>.map, which Linux perf reads to name addresses that have no ELF symbols.
+// Each line is "<start> <size> <name>" with the start and size in hex. Enabled with -Xperf-map.
+// A process forked from the zygote needs a map of its own, see Runtime::DidForkFromZygote.
+class PerfMap {
+ public:
+  // Where perf looks for the maps.
+  static constexpr const char* kDefaultDirectory = "/tmp";
+
+  // Creates <directory>/perf-<pid>.map for this process, returns nullptr and sets error_msg on
+  // failure.
+  static PerfMap* Create(const std::string& directory, std::string* error_msg);
+
+  ~PerfMap();
+
+  // Adds the trampolines and the compiled methods of an executable oat file.
+  void AddOatFile(const OatFile& oat_file) LOCKS_EXCLUDED(lock_);
+
+ private:
+  explicit PerfMap(File* file);
+
+  void Write(const std::string& lines) LOCKS_EXCLUDED(lock_);
+
+  // Keeps lines from different oat files from interleaving.
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::unique_ptr<File> file_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(PerfMap);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_PERF_MAP_H_
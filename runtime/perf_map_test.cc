@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "perf_map.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "base/stringprintf.h"
+#include "class_linker.h"
+#include "common_runtime_test.h"
+#include "oat_file.h"
+#include "scoped_thread_state_change.h"
+#include "utils.h"
+
+namespace art {
+
+class PerfMapTest : public CommonRuntimeTest {
+ protected:
+  const OatFile* GetBootOatFile() {
+    ScopedObjectAccess soa(Thread::Current());
+    const OatFile::OatDexFile* oat_dex_file =
+        class_linker_->FindOpenedOatDexFileForDexFile(*java_lang_dex_file_);
+    return (oat_dex_file == nullptr) ? nullptr : oat_dex_file->GetOatFile();
+  }
+};
+
+TEST_F(PerfMapTest, BootOatFile) {
+  const OatFile* oat_file = GetBootOatFile();
+  ASSERT_TRUE(oat_file != nullptr);
+  std::string error_msg;
+  // Target devices have no /tmp.
+  std::unique_ptr<PerfMap> perf_map(PerfMap::Create(android_data_, &error_msg));
+  ASSERT_TRUE(perf_map.get() != nullptr) << error_msg;
+  perf_map->AddOatFile(*oat_file);
+  perf_map.reset();
+
+  std::string filename = StringPrintf("%s/perf-%d.map", android_data_.c_str(), getpid());
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(filename, &contents));
+  unlink(filename.c_str());
+  if (!oat_file->IsExecutable()) {
+    EXPECT_TRUE(contents.empty());
+    return;
+  }
+  EXPECT_NE(std::string::npos, contents.find(" art_quick_resolution_trampoline\n"));
+  EXPECT_NE(std::string::npos, contents.find(" java.lang.String."));
+
+  // Every line is a code range inside the oat file followed by a name.
+  std::vector<std::string> lines;
+  Split(contents, '\n', lines);
+  ASSERT_FALSE(lines.empty());
+  for (const std::string& line : lines) {
+    uintptr_t start;
+    size_t size;
+    int name_pos = 0;
+    ASSERT_EQ(2, sscanf(line.c_str(), "%" SCNxPTR " %zx %n", &start, &size, &name_pos)) << line;
+    EXPECT_LT(static_cast<size_t>(name_pos), line.size()) << line;
+    EXPECT_LE(reinterpret_cast<uintptr_t>(oat_file->Begin()), start) << line;
+    EXPECT_LE(start + size, reinterpret_cast<uintptr_t>(oat_file->End())) << line;
+  }
+}
+
+}  // namespace art
@@ -87,30 +87,26 @@ class BoundedStackVisitor : public StackVisitor {
 };
 
 // This is called from either a thread list traversal or from a checkpoint.  Regardless
-// of which caller, the mutator lock must be held.
+// of which caller, the mutator lock must be held. The sample is only stored in the sample
+// buffer here, the profiler thread records it later.
 static void GetSample(Thread* thread, void* arg) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
   BackgroundMethodSamplingProfiler* profiler =
       reinterpret_cast<BackgroundMethodSamplingProfiler*>(arg);
-  const ProfilerOptions profile_options = profiler->GetProfilerOptions();
+  const ProfilerOptions& profile_options = profiler->GetProfilerOptions();
+  std::vector<InstructionLocation>* stack = profiler->GetSampleBuffer().Claim();
+  if (stack == nullptr) {
+    return;
+  }
   switch (profile_options.GetProfileType()) {
     case kProfilerMethod: {
       mirror::ArtMethod* method = thread->GetCurrentMethod(nullptr);
-      if (false && method == nullptr) {
-        LOG(INFO) << "No current method available";
-        std::ostringstream os;
-        thread->Dump(os);
-        std::string data(os.str());
-        LOG(INFO) << data;
-      }
-      profiler->RecordMethod(method);
+      stack->push_back(std::make_pair(method, 0U));
       break;
     }
     case kProfilerBoundedStack: {
-      std::vector<InstructionLocation> stack;
       uint32_t max_depth = profile_options.GetMaxStackDepth();
-      BoundedStackVisitor bounded_stack_visitor(&stack, thread, max_depth);
+      BoundedStackVisitor bounded_stack_visitor(stack, thread, max_depth);
       bounded_stack_visitor.WalkStack();
-      profiler->RecordStack(stack);
       break;
     }
     default:
@@ -118,6 +114,33 @@ static void GetSample(Thread* thread, void* arg) SHARED_LOCKS_REQUIRED(Locks::mu
   }
 }
 
+ProfileSampleBuffer::ProfileSampleBuffer(uint32_t max_depth)
+    : max_depth_(max_depth), next_slot_(0), num_dropped_(0) {
+}
+
+void ProfileSampleBuffer::Reset(size_t num_threads) {
+  while (samples_.size() < num_threads) {
+    samples_.push_back(std::vector<InstructionLocation>());
+    samples_.back().reserve(max_depth_);
+  }
+  next_slot_.StoreRelaxed(0);
+  num_dropped_.StoreRelaxed(0);
+}
+
+std::vector<InstructionLocation>* ProfileSampleBuffer::Claim() {
+  const size_t slot = next_slot_.FetchAndAddSequentiallyConsistent(1);
+  if (UNLIKELY(slot >= samples_.size())) {
+    num_dropped_.FetchAndAddSequentiallyConsistent(1);
+    return nullptr;
+  }
+  samples_[slot].clear();
+  return &samples_[slot];
+}
+
+size_t ProfileSampleBuffer::Size() const {
+  return std::min(static_cast<size_t>(next_slot_.LoadRelaxed()), samples_.size());
+}
+
 // A closure that is called by the thread checkpoint code.
 class SampleCheckpoint : public Closure {
  public:
@@ -221,6 +244,10 @@ void* BackgroundMethodSamplingProfiler::RunProfilerThread(void* arg) {
 
       ThreadList* thread_list = runtime->GetThreadList();
 
+      {
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        profiler->sample_buffer_.Reset(thread_list->GetList().size());
+      }
       profiler->profiler_barrier_->Init(self, 0);
       size_t barrier_count = thread_list->RunCheckpointOnRunnableThreads(&check_point);
 
@@ -250,6 +277,11 @@ void* BackgroundMethodSamplingProfiler::RunProfilerThread(void* arg) {
       // code.  Crash the process in this case.
       CHECK_LT(waitdiff_us, kWaitTimeoutUs);
 
+      {
+        ScopedObjectAccess soa(self);
+        profiler->RecordSamples();
+      }
+
       // Update the current time.
       now_us = MicroTime();
     }
@@ -394,6 +426,7 @@ BackgroundMethodSamplingProfiler::BackgroundMethodSamplingProfiler(
       wait_lock_("Profile wait lock"),
       period_condition_("Profile condition", wait_lock_),
       profile_table_(wait_lock_),
+      sample_buffer_(options.GetProfileType() == kProfilerMethod ? 1 : options.GetMaxStackDepth()),
       profiler_barrier_(new Barrier(0)) {
   // Populate the filtered_methods set.
   // This is empty right now, but to add a method, do this:
@@ -457,6 +490,21 @@ void BackgroundMethodSamplingProfiler::RecordStack(const std::vector<Instruction
   }
 }
 
+void BackgroundMethodSamplingProfiler::RecordSamples() {
+  const bool method_only = options_.GetProfileType() == kProfilerMethod;
+  for (size_t i = 0; i < sample_buffer_.Size(); ++i) {
+    const std::vector<InstructionLocation>& stack = sample_buffer_.Get(i);
+    if (method_only) {
+      RecordMethod(stack.empty() ? nullptr : stack.front().first);
+    } else {
+      RecordStack(stack);
+    }
+  }
+  if (sample_buffer_.NumDropped() != 0) {
+    VLOG(profiler) << "Dropped " << sample_buffer_.NumDropped() << " samples";
+  }
+}
+
 // Clean out any recordings for the method traces.
 void BackgroundMethodSamplingProfiler::CleanProfile() {
   profile_table_.Clear();
@@ -872,8 +920,9 @@ bool ProfileFile::LoadFile(const std::string& fileName) {
   return true;
 }
 
-bool ProfileFile::GetProfileData(ProfileFile::ProfileData* data, const std::string& method_name) {
-  ProfileMap::iterator i = profile_map_.find(method_name);
+bool ProfileFile::GetProfileData(ProfileFile::ProfileData* data,
+                                 const std::string& method_name) const {
+  ProfileMap::const_iterator i = profile_map_.find(method_name);
   if (i == profile_map_.end()) {
     return false;
   }
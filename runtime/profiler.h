@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include "atomic.h"
 #include "barrier.h"
 #include "base/macros.h"
 #include "base/mutex.h"
@@ -148,6 +149,42 @@ class ProfileSampleResults {
   uint32_t previous_num_boot_methods_;     // Number of samples in the boot path.
 };
 
+// The samples taken by the checkpoints of one sampling round. Each sampled thread claims a slot
+// with an atomic increment and fills it in without taking a lock. The profiler thread adds the
+// samples to the ProfileSampleResults once all threads have passed the barrier, which keeps the
+// table updates off the sampled threads.
+class ProfileSampleBuffer {
+ public:
+  explicit ProfileSampleBuffer(uint32_t max_depth);
+
+  // Makes room for a round with up to num_threads samples and drops the previous round.
+  void Reset(size_t num_threads);
+
+  // Returns an empty stack to fill in for a new sample, or nullptr if the round is full.
+  std::vector<InstructionLocation>* Claim();
+
+  // Number of samples taken in this round.
+  size_t Size() const;
+
+  const std::vector<InstructionLocation>& Get(size_t i) const {
+    return samples_[i];
+  }
+
+  // Number of samples lost in this round because threads started after it was reset.
+  size_t NumDropped() const {
+    return num_dropped_.LoadRelaxed();
+  }
+
+ private:
+  // Stacks are reserved to this depth so that filling them in does not allocate.
+  const uint32_t max_depth_;
+  std::vector<std::vector<InstructionLocation>> samples_;
+  AtomicInteger next_slot_;
+  AtomicInteger num_dropped_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfileSampleBuffer);
+};
+
 //
 // The BackgroundMethodSamplingProfiler runs in a thread.  Most of the time it is sleeping but
 // occasionally wakes up and counts the number of times a method is called.  Each time
@@ -181,6 +218,10 @@ class BackgroundMethodSamplingProfiler {
   bool ProcessMethod(mirror::ArtMethod* method) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   const ProfilerOptions& GetProfilerOptions() const { return options_; }
 
+  ProfileSampleBuffer& GetSampleBuffer() {
+    return sample_buffer_;
+  }
+
   Barrier& GetBarrier() {
     return *profiler_barrier_;
   }
@@ -194,6 +235,9 @@ class BackgroundMethodSamplingProfiler {
 
   uint32_t WriteProfile() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Adds the samples of the last round to the profile table.
+  void RecordSamples() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   void CleanProfile();
   uint32_t DumpProfile(std::ostream& os) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static bool ShuttingDown(Thread* self) LOCKS_EXCLUDED(Locks::profiler_lock_);
@@ -221,6 +265,8 @@ class BackgroundMethodSamplingProfiler {
 
   ProfileSampleResults profile_table_;
 
+  ProfileSampleBuffer sample_buffer_;
+
   std::unique_ptr<Barrier> profiler_barrier_;
 
   // Set of methods to be filtered out.  This will probably be rare because
@@ -271,7 +317,7 @@ class ProfileFile {
 
   // If the given method has an entry in the profile table it updates the data
   // and returns true. Otherwise returns false and leaves the data unchanged.
-  bool GetProfileData(ProfileData* data, const std::string& method_name);
+  bool GetProfileData(ProfileData* data, const std::string& method_name) const;
 
  private:
   // Profile data is stored in a map, indexed by the full method name.
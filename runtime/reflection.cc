@@ -28,6 +28,7 @@
 #include "mirror/object_array-inl.h"
 #include "mirror/object_array.h"
 #include "nth_caller_visitor.h"
+#include "reflection_invoke_cache.h"
 #include "scoped_thread_state_change.h"
 #include "stack.h"
 #include "well_known_classes.h"
@@ -218,11 +219,16 @@ class ArgArray {
                      PrettyDescriptor(found_descriptor).c_str()).c_str());
   }
 
+  // Boxed arguments are matched against the box classes by identity, see
+  // ReflectionInvokeCache::GetBoxClass.
   bool BuildArgArrayFromObjectArray(const ScopedObjectAccessAlreadyRunnable& soa,
                                     mirror::Object* receiver,
-                                    mirror::ObjectArray<mirror::Object>* args, MethodHelper& mh)
+                                    mirror::ObjectArray<mirror::Object>* args,
+                                    const ReflectionInvokeAdapter& adapter,
+                                    const ReflectionInvokeCache& cache)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
-    const DexFile::TypeList* classes = mh.GetMethod()->GetParameterTypeList();
+    mirror::ArtMethod* m = adapter.method;
+    const DexFile::TypeList* classes = adapter.param_types;
     // Set receiver if non-null (method is not static)
     if (receiver != nullptr) {
       Append(receiver);
@@ -230,12 +236,16 @@ class ArgArray {
     for (size_t i = 1, args_offset = 0; i < shorty_len_; ++i, ++args_offset) {
       mirror::Object* arg = args->Get(args_offset);
       if (((shorty_[i] == 'L') && (arg != nullptr)) || ((arg == nullptr && shorty_[i] != 'L'))) {
-        mirror::Class* dst_class =
-            mh.GetClassFromTypeIdx(classes->GetTypeItem(args_offset).type_idx_);
+        uint16_t type_idx = classes->GetTypeItem(args_offset).type_idx_;
+        mirror::Class* dst_class = m->GetDexCacheResolvedType(type_idx);
+        if (UNLIKELY(dst_class == nullptr)) {
+          dst_class = Runtime::Current()->GetClassLinker()->ResolveType(type_idx, m);
+          CHECK(dst_class != nullptr || soa.Self()->IsExceptionPending());
+        }
         if (UNLIKELY(arg == nullptr || !arg->InstanceOf(dst_class))) {
           ThrowIllegalArgumentException(nullptr,
               StringPrintf("method %s argument %zd has type %s, got %s",
-                  PrettyMethod(mh.GetMethod(), false).c_str(),
+                  PrettyMethod(m, false).c_str(),
                   args_offset + 1,  // Humans don't count from 0.
                   PrettyDescriptor(dst_class).c_str(),
                   PrettyTypeOf(arg).c_str()).c_str());
@@ -243,14 +253,14 @@ class ArgArray {
         }
       }
 
-#define DO_FIRST_ARG(match_descriptor, get_fn, append) { \
-          if (LIKELY(arg != nullptr && arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
+#define DO_FIRST_ARG(match_type, get_fn, append) { \
+          if (LIKELY(arg != nullptr && arg->GetClass<>() == cache.GetBoxClass(match_type))) { \
             mirror::ArtField* primitive_field = arg->GetClass()->GetIFields()->Get(0); \
             append(primitive_field-> get_fn(arg));
 
-#define DO_ARG(match_descriptor, get_fn, append) \
+#define DO_ARG(match_type, get_fn, append) \
           } else if (LIKELY(arg != nullptr && \
-                            arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
+                            arg->GetClass<>() == cache.GetBoxClass(match_type))) { \
             mirror::ArtField* primitive_field = arg->GetClass()->GetIFields()->Get(0); \
             append(primitive_field-> get_fn(arg));
 
@@ -263,7 +273,7 @@ class ArgArray {
             } else { \
               ThrowIllegalArgumentException(nullptr, \
                   StringPrintf("method %s argument %zd has type %s, got %s", \
-                      PrettyMethod(mh.GetMethod(), false).c_str(), \
+                      PrettyMethod(m, false).c_str(), \
                       args_offset + 1, \
                       expected, \
                       PrettyTypeOf(arg).c_str()).c_str()); \
@@ -276,54 +286,54 @@ class ArgArray {
           Append(arg);
           break;
         case 'Z':
-          DO_FIRST_ARG("Ljava/lang/Boolean;", GetBoolean, Append)
+          DO_FIRST_ARG(Primitive::kPrimBoolean, GetBoolean, Append)
           DO_FAIL("boolean")
           break;
         case 'B':
-          DO_FIRST_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(Primitive::kPrimByte, GetByte, Append)
           DO_FAIL("byte")
           break;
         case 'C':
-          DO_FIRST_ARG("Ljava/lang/Character;", GetChar, Append)
+          DO_FIRST_ARG(Primitive::kPrimChar, GetChar, Append)
           DO_FAIL("char")
           break;
         case 'S':
-          DO_FIRST_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(Primitive::kPrimShort, GetShort, Append)
+          DO_ARG(Primitive::kPrimByte, GetByte, Append)
           DO_FAIL("short")
           break;
         case 'I':
-          DO_FIRST_ARG("Ljava/lang/Integer;", GetInt, Append)
-          DO_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(Primitive::kPrimInt, GetInt, Append)
+          DO_ARG(Primitive::kPrimChar, GetChar, Append)
+          DO_ARG(Primitive::kPrimShort, GetShort, Append)
+          DO_ARG(Primitive::kPrimByte, GetByte, Append)
           DO_FAIL("int")
           break;
         case 'J':
-          DO_FIRST_ARG("Ljava/lang/Long;", GetLong, AppendWide)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendWide)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendWide)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendWide)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendWide)
+          DO_FIRST_ARG(Primitive::kPrimLong, GetLong, AppendWide)
+          DO_ARG(Primitive::kPrimInt, GetInt, AppendWide)
+          DO_ARG(Primitive::kPrimChar, GetChar, AppendWide)
+          DO_ARG(Primitive::kPrimShort, GetShort, AppendWide)
+          DO_ARG(Primitive::kPrimByte, GetByte, AppendWide)
           DO_FAIL("long")
           break;
         case 'F':
-          DO_FIRST_ARG("Ljava/lang/Float;", GetFloat, AppendFloat)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendFloat)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendFloat)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendFloat)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendFloat)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendFloat)
+          DO_FIRST_ARG(Primitive::kPrimFloat, GetFloat, AppendFloat)
+          DO_ARG(Primitive::kPrimLong, GetLong, AppendFloat)
+          DO_ARG(Primitive::kPrimInt, GetInt, AppendFloat)
+          DO_ARG(Primitive::kPrimChar, GetChar, AppendFloat)
+          DO_ARG(Primitive::kPrimShort, GetShort, AppendFloat)
+          DO_ARG(Primitive::kPrimByte, GetByte, AppendFloat)
           DO_FAIL("float")
           break;
         case 'D':
-          DO_FIRST_ARG("Ljava/lang/Double;", GetDouble, AppendDouble)
-          DO_ARG("Ljava/lang/Float;", GetFloat, AppendDouble)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendDouble)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendDouble)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendDouble)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendDouble)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendDouble)
+          DO_FIRST_ARG(Primitive::kPrimDouble, GetDouble, AppendDouble)
+          DO_ARG(Primitive::kPrimFloat, GetFloat, AppendDouble)
+          DO_ARG(Primitive::kPrimLong, GetLong, AppendDouble)
+          DO_ARG(Primitive::kPrimInt, GetInt, AppendDouble)
+          DO_ARG(Primitive::kPrimChar, GetChar, AppendDouble)
+          DO_ARG(Primitive::kPrimShort, GetShort, AppendDouble)
+          DO_ARG(Primitive::kPrimByte, GetByte, AppendDouble)
           DO_FAIL("double")
           break;
 #ifndef NDEBUG
@@ -551,11 +561,15 @@ jobject InvokeMethod(const ScopedObjectAccessAlreadyRunnable& soa, jobject javaM
     m = receiver->GetClass()->FindVirtualMethodForVirtualOrInterface(m);
   }
 
+  // Look up what we need to know about the method's signature, decoded on first use.
+  ReflectionInvokeCache* invoke_cache = Runtime::Current()->GetReflectionInvokeCache();
+  ReflectionInvokeAdapter scratch_adapter;
+  const ReflectionInvokeAdapter* adapter = invoke_cache->GetAdapter(m, &scratch_adapter);
+
   // Get our arrays of arguments and their types, and check they're the same size.
   mirror::ObjectArray<mirror::Object>* objects =
       soa.Decode<mirror::ObjectArray<mirror::Object>*>(javaArgs);
-  const DexFile::TypeList* classes = m->GetParameterTypeList();
-  uint32_t classes_size = (classes == nullptr) ? 0 : classes->Size();
+  uint32_t classes_size = adapter->num_params;
   uint32_t arg_count = (objects != nullptr) ? objects->GetLength() : 0;
   if (arg_count != classes_size) {
     ThrowIllegalArgumentException(NULL,
@@ -573,17 +587,13 @@ jobject InvokeMethod(const ScopedObjectAccessAlreadyRunnable& soa, jobject javaM
 
   // Invoke the method.
   JValue result;
-  uint32_t shorty_len = 0;
-  const char* shorty = m->GetShorty(&shorty_len);
-  ArgArray arg_array(shorty, shorty_len);
-  StackHandleScope<1> hs(soa.Self());
-  MethodHelper mh(hs.NewHandle(m));
-  if (!arg_array.BuildArgArrayFromObjectArray(soa, receiver, objects, mh)) {
+  ArgArray arg_array(adapter->shorty, adapter->shorty_len);
+  if (!arg_array.BuildArgArrayFromObjectArray(soa, receiver, objects, *adapter, *invoke_cache)) {
     CHECK(soa.Self()->IsExceptionPending());
     return nullptr;
   }
 
-  InvokeWithArgArray(soa, m, &arg_array, &result, shorty);
+  InvokeWithArgArray(soa, m, &arg_array, &result, adapter->shorty);
 
   // Wrap any exception with "Ljava/lang/reflect/InvocationTargetException;" and return early.
   if (soa.Self()->IsExceptionPending()) {
@@ -597,8 +607,7 @@ jobject InvokeMethod(const ScopedObjectAccessAlreadyRunnable& soa, jobject javaM
   }
 
   // Box if necessary and return.
-  return soa.AddLocalReference<jobject>(BoxPrimitive(mh.GetReturnType()->GetPrimitiveType(),
-                                                     result));
+  return soa.AddLocalReference<jobject>(BoxPrimitive(adapter->return_type, result));
 }
 
 bool VerifyObjectIsClass(mirror::Object* o, mirror::Class* c) {
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "reflection_invoke_cache.h"
+
+#include <algorithm>
+
+#include "base/stl_util.h"
+#include "mirror/art_method-inl.h"
+#include "mirror/class-inl.h"
+#include "thread-inl.h"
+#include "well_known_classes.h"
+
+namespace art {
+
+static mirror::Class* BoxClass(jmethodID value_of)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  // A jmethodID is the ArtMethod itself.
+  return reinterpret_cast<mirror::ArtMethod*>(value_of)->GetDeclaringClass();
+}
+
+void ReflectionInvokeAdapter::Init(mirror::ArtMethod* m) {
+  method = m;
+  shorty = m->GetShorty(&shorty_len);
+  param_types = m->GetParameterTypeList();
+  num_params = (param_types == nullptr) ? 0 : param_types->Size();
+  return_type = Primitive::GetType(shorty[0]);
+}
+
+ReflectionInvokeCache::ReflectionInvokeCache()
+    : lock_("Reflection invoke cache lock", kReflectionInvokeCacheLock) {
+  std::fill_n(box_classes_, arraysize(box_classes_), nullptr);
+}
+
+ReflectionInvokeCache::~ReflectionInvokeCache() {
+  STLDeleteElements(&adapters_);
+}
+
+const ReflectionInvokeAdapter* ReflectionInvokeCache::GetAdapter(
+    mirror::ArtMethod* method, ReflectionInvokeAdapter* scratch) {
+  Atomic<const ReflectionInvokeAdapter*>* slot = &slots_[SlotFor(method)];
+  const ReflectionInvokeAdapter* adapter = slot->LoadSequentiallyConsistent();
+  if (LIKELY(adapter != nullptr && adapter->method == method)) {
+    return adapter;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  InitBoxClasses();
+  adapter = slot->LoadRelaxed();
+  if (adapter == nullptr) {
+    ReflectionInvokeAdapter* new_adapter = new ReflectionInvokeAdapter;
+    new_adapter->Init(method);
+    adapters_.push_back(new_adapter);
+    slot->StoreSequentiallyConsistent(new_adapter);
+    return new_adapter;
+  }
+  if (adapter->method == method) {
+    return adapter;
+  }
+  scratch->Init(method);
+  return scratch;
+}
+
+size_t ReflectionInvokeCache::Size() {
+  MutexLock mu(Thread::Current(), lock_);
+  return adapters_.size();
+}
+
+void ReflectionInvokeCache::InitBoxClasses() {
+  if (box_classes_[Primitive::kPrimInt] != nullptr) {
+    return;
+  }
+  box_classes_[Primitive::kPrimBoolean] = BoxClass(WellKnownClasses::java_lang_Boolean_valueOf);
+  box_classes_[Primitive::kPrimByte] = BoxClass(WellKnownClasses::java_lang_Byte_valueOf);
+  box_classes_[Primitive::kPrimChar] = BoxClass(WellKnownClasses::java_lang_Character_valueOf);
+  box_classes_[Primitive::kPrimShort] = BoxClass(WellKnownClasses::java_lang_Short_valueOf);
+  box_classes_[Primitive::kPrimLong] = BoxClass(WellKnownClasses::java_lang_Long_valueOf);
+  box_classes_[Primitive::kPrimFloat] = BoxClass(WellKnownClasses::java_lang_Float_valueOf);
+  box_classes_[Primitive::kPrimDouble] = BoxClass(WellKnownClasses::java_lang_Double_valueOf);
+  // Checked above, so set last.
+  box_classes_[Primitive::kPrimInt] = BoxClass(WellKnownClasses::java_lang_Integer_valueOf);
+}
+
+}  // namespace art
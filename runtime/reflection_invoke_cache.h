@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_REFLECTION_INVOKE_CACHE_H_
+#define ART_RUNTIME_REFLECTION_INVOKE_CACHE_H_
+
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "dex_file.h"
+#include "primitive.h"
+
+namespace art {
+namespace mirror {
+  class ArtMethod;
+  class Class;
+}  // namespace mirror
+
+// What Method.invoke and Constructor.newInstance need to know about the method they call,
+// decoded once from the dex file instead of on every call.
+struct ReflectionInvokeAdapter {
+  mirror::ArtMethod* method;
+  const char* shorty;
+  uint32_t shorty_len;
+  const DexFile::TypeList* param_types;
+  uint32_t num_params;
+  // Taken from the shorty, so the return type never has to be resolved to box the result.
+  Primitive::Type return_type;
+
+  void Init(mirror::ArtMethod* m) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+};
+
+// Invocation adapters for methods called through reflection, built on first use. Lookups are a
+// single load from a direct mapped table and take no lock. ArtMethods are never moved or freed,
+// so they are used as keys directly. When two methods map to the same slot the first one keeps
+// it and the other gets a fresh adapter on each call, which keeps the cache bounded.
+class ReflectionInvokeCache {
+ public:
+  static constexpr size_t kNumSlots = 1024;
+
+  ReflectionInvokeCache();
+  ~ReflectionInvokeCache();
+
+  // Returns the adapter for method, using scratch if it can not be cached.
+  const ReflectionInvokeAdapter* GetAdapter(mirror::ArtMethod* method,
+                                            ReflectionInvokeAdapter* scratch)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(lock_);
+
+  // The java.lang box class for a primitive type, so that arguments can be unboxed by class
+  // identity rather than by comparing descriptors. Only valid once an adapter was returned.
+  mirror::Class* GetBoxClass(Primitive::Type type) const {
+    DCHECK_LT(static_cast<size_t>(type), arraysize(box_classes_));
+    return box_classes_[type];
+  }
+
+  // Number of cached adapters, for tests.
+  size_t Size() LOCKS_EXCLUDED(lock_);
+
+ private:
+  static size_t SlotFor(mirror::ArtMethod* method) {
+    // Objects are at least 8 byte aligned.
+    return (reinterpret_cast<uintptr_t>(method) >> 3) % kNumSlots;
+  }
+
+  void InitBoxClasses() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  Atomic<const ReflectionInvokeAdapter*> slots_[kNumSlots];
+  // Owns the adapters in slots_.
+  std::vector<ReflectionInvokeAdapter*> adapters_ GUARDED_BY(lock_);
+  // Classes are not moved by the GC. Written once under lock_ before the first adapter is
+  // published.
+  mirror::Class* box_classes_[Primitive::kPrimVoid + 1];
+
+  DISALLOW_COPY_AND_ASSIGN(ReflectionInvokeCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_REFLECTION_INVOKE_CACHE_H_
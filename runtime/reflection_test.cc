@@ -21,7 +21,10 @@
 #include "ScopedLocalRef.h"
 
 #include "common_compiler_test.h"
+#include "mirror/art_field-inl.h"
 #include "mirror/art_method-inl.h"
+#include "mirror/object_array-inl.h"
+#include "reflection_invoke_cache.h"
 #include "scoped_thread_state_change.h"
 
 namespace art {
@@ -637,4 +640,62 @@ TEST_F(ReflectionTest, NonStaticSumDoubleDoubleDoubleDoubleDoubleMethod) {
   InvokeSumDoubleDoubleDoubleDoubleDoubleMethod(false);
 }
 
+static void SetBoxedArg(const ScopedObjectAccess& soa, jobjectArray args, jsize index,
+                        Primitive::Type type, const JValue& value)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  // Box first, allocating may move the array.
+  mirror::Object* boxed = BoxPrimitive(type, value);
+  soa.Decode<mirror::ObjectArray<mirror::Object>*>(args)->Set<false>(index, boxed);
+}
+
+static int32_t InvokeAndUnboxInt(const ScopedObjectAccess& soa, jobject java_method,
+                                 jobjectArray args)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  mirror::Object* result =
+      soa.Decode<mirror::Object*>(InvokeMethod(soa, java_method, nullptr, args, true));
+  return (result == nullptr) ? 0 : result->GetClass()->GetIFields()->Get(0)->GetInt(result);
+}
+
+TEST_F(ReflectionTest, InvokeMethodCachesAdapter) {
+  TEST_DISABLED_FOR_PORTABLE();
+  ScopedObjectAccess soa(env_);
+  mirror::ArtMethod* method;
+  mirror::Object* receiver;
+  ReflectionTestMakeExecutable(&method, &receiver, true, "sum", "(II)I");
+  ScopedLocalRef<jclass> klass(env_,
+                               soa.AddLocalReference<jclass>(method->GetDeclaringClass()));
+  ScopedLocalRef<jobject> java_method(env_,
+      env_->ToReflectedMethod(klass.get(), soa.EncodeMethod(method), JNI_TRUE));
+  ASSERT_TRUE(java_method.get() != nullptr);
+  ScopedLocalRef<jclass> object_class(env_, env_->FindClass("java/lang/Object"));
+  ScopedLocalRef<jobjectArray> args(env_, env_->NewObjectArray(2, object_class.get(), nullptr));
+
+  ReflectionInvokeCache* cache = Runtime::Current()->GetReflectionInvokeCache();
+  size_t cached = cache->Size();
+  JValue value;
+  value.SetI(40);
+  SetBoxedArg(soa, args.get(), 0, Primitive::kPrimInt, value);
+  value.SetB(2);
+  SetBoxedArg(soa, args.get(), 1, Primitive::kPrimByte, value);
+  EXPECT_EQ(42, InvokeAndUnboxInt(soa, java_method.get(), args.get()));
+  EXPECT_FALSE(soa.Self()->IsExceptionPending());
+  EXPECT_EQ(cached + 1, cache->Size());
+
+  // Calling again uses the cached adapter, and widening conversions still apply.
+  value.SetS(-3);
+  SetBoxedArg(soa, args.get(), 0, Primitive::kPrimShort, value);
+  value.SetC('a');
+  SetBoxedArg(soa, args.get(), 1, Primitive::kPrimChar, value);
+  EXPECT_EQ('a' - 3, InvokeAndUnboxInt(soa, java_method.get(), args.get()));
+  EXPECT_FALSE(soa.Self()->IsExceptionPending());
+  EXPECT_EQ(cached + 1, cache->Size());
+
+  // Narrowing is still rejected.
+  value.SetJ(1);
+  SetBoxedArg(soa, args.get(), 1, Primitive::kPrimLong, value);
+  InvokeAndUnboxInt(soa, java_method.get(), args.get());
+  EXPECT_TRUE(soa.Self()->IsExceptionPending());
+  soa.Self()->ClearException();
+}
+
 }  // namespace art
@@ -49,6 +49,7 @@
 #include "elf_file.h"
 #include "fault_handler.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "gc/space/space.h"
@@ -56,6 +57,7 @@
 #include "instrumentation.h"
 #include "intern_table.h"
 #include "jni_internal.h"
+#include "mapping_table_index.h"
 #include "mirror/art_field-inl.h"
 #include "mirror/art_method-inl.h"
 #include "mirror/array.h"
@@ -68,8 +70,10 @@
 #include "parsed_options.h"
 #include "oat_file.h"
 #include "os.h"
+#include "perf_map.h"
 #include "quick/quick_method_frame_info.h"
 #include "reflection.h"
+#include "reflection_invoke_cache.h"
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "sigchain.h"
@@ -113,6 +117,9 @@ Runtime::Runtime()
       monitor_pool_(nullptr),
       thread_list_(nullptr),
       intern_table_(nullptr),
+      mapping_table_index_(nullptr),
+      reflection_invoke_cache_(nullptr),
+      perf_map_(nullptr),
       class_linker_(nullptr),
       signal_catcher_(nullptr),
       java_vm_(nullptr),
@@ -197,6 +204,9 @@ Runtime::~Runtime() {
   delete class_linker_;
   delete heap_;
   delete intern_table_;
+  delete mapping_table_index_;
+  delete reflection_invoke_cache_;
+  delete perf_map_;
   delete java_vm_;
   Thread::Shutdown();
   QuasiAtomic::Shutdown();
@@ -543,6 +553,26 @@ void Runtime::DidForkFromZygote(JNIEnv* env, NativeBridgeAction action, const ch
     }
   }
 
+  if (perf_map_ != nullptr) {
+    // The inherited map is the zygote's, named after its pid. Start one for this process with
+    // the oat files the zygote had opened.
+    std::string error_msg;
+    PerfMap* perf_map = PerfMap::Create(PerfMap::kDefaultDirectory, &error_msg);
+    if (perf_map == nullptr) {
+      LOG(WARNING) << error_msg;
+    } else {
+      class_linker_->AddOatFilesToPerfMap(perf_map);
+    }
+    PerfMap* zygote_perf_map = perf_map_;
+    perf_map_ = perf_map;
+    delete zygote_perf_map;
+  }
+
+  gc::AllocationSampler* allocation_sampler = heap_->GetAllocationSampler();
+  if (allocation_sampler != nullptr) {
+    allocation_sampler->DidForkFromZygote();
+  }
+
   // Create the thread pool.
   heap_->CreateThreadPool();
 
@@ -712,6 +742,16 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
   monitor_pool_ = MonitorPool::Create();
   thread_list_ = new ThreadList;
   intern_table_ = new InternTable;
+  mapping_table_index_ = new MappingTableIndex;
+  reflection_invoke_cache_ = new ReflectionInvokeCache;
+  if (options->perf_map_) {
+    // Created before the class linker so that the boot oat files are added too.
+    std::string error_msg;
+    perf_map_ = PerfMap::Create(PerfMap::kDefaultDirectory, &error_msg);
+    if (perf_map_ == nullptr) {
+      LOG(WARNING) << error_msg;
+    }
+  }
 
   verify_ = options->verify_;
 
@@ -856,6 +896,11 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
                  false, false, 0);
   }
 
+  if (!options->alloc_sample_file_.empty()) {
+    ScopedThreadStateChange tsc(self, kNative);
+    heap_->StartAllocationSampling(options->alloc_sample_interval_, options->alloc_sample_file_);
+  }
+
   // Pre-allocate an OutOfMemoryError for the double-OOME case.
   self->ThrowNewException(ThrowLocation(), "Ljava/lang/OutOfMemoryError;",
                           "OutOfMemoryError thrown while trying to throw OutOfMemoryError; "
@@ -1272,6 +1317,16 @@ void Runtime::DisallowNewSystemWeaks() {
   java_vm_->DisallowNewWeakGlobals();
 }
 
+void Runtime::SweepAndAllowNewSystemWeaks(IsMarkedCallback* visitor, void* arg) {
+  // The monitor list and the weak globals are small, get them out of the way first.
+  monitor_list_->SweepMonitorList(visitor, arg);
+  monitor_list_->AllowNewMonitors();
+  java_vm_->SweepJniWeakGlobals(visitor, arg);
+  java_vm_->AllowNewWeakGlobals();
+  intern_table_->SweepInternTableWeaks(visitor, arg);
+  intern_table_->AllowNewInterns();
+}
+
 void Runtime::AllowNewSystemWeaks() {
   monitor_list_->AllowNewMonitors();
   intern_table_->AllowNewInterns();
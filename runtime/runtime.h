@@ -61,9 +61,12 @@ class ClassLinker;
 class DexFile;
 class InternTable;
 class JavaVMExt;
+class MappingTableIndex;
 class MonitorList;
 class MonitorPool;
 class NullPointerHandler;
+class PerfMap;
+class ReflectionInvokeCache;
 class SignalCatcher;
 class StackOverflowHandler;
 class SuspensionHandler;
@@ -235,6 +238,21 @@ class Runtime {
     return intern_table_;
   }
 
+  MappingTableIndex* GetMappingTableIndex() const {
+    DCHECK(mapping_table_index_ != nullptr);
+    return mapping_table_index_;
+  }
+
+  ReflectionInvokeCache* GetReflectionInvokeCache() const {
+    DCHECK(reflection_invoke_cache_ != nullptr);
+    return reflection_invoke_cache_;
+  }
+
+  // Returns nullptr unless -Xperf-map was given.
+  PerfMap* GetPerfMap() const {
+    return perf_map_;
+  }
+
   JavaVMExt* GetJavaVM() const {
     return java_vm_;
   }
@@ -294,6 +312,11 @@ class Runtime {
   void SweepSystemWeaks(IsMarkedCallback* visitor, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Like SweepSystemWeaks followed by AllowNewSystemWeaks, but lets threads back into each table
+  // as soon as that table is swept, and into the intern table while it is being swept.
+  void SweepAndAllowNewSystemWeaks(IsMarkedCallback* visitor, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Constant roots are the roots which never change after the runtime is initialized, they only
   // need to be visited once per GC cycle.
   void VisitConstantRoots(RootCallback* callback, void* arg)
@@ -563,6 +586,12 @@ class Runtime {
 
   InternTable* intern_table_;
 
+  MappingTableIndex* mapping_table_index_;
+
+  ReflectionInvokeCache* reflection_invoke_cache_;
+
+  PerfMap* perf_map_;
+
   ClassLinker* class_linker_;
 
   SignalCatcher* signal_catcher_;
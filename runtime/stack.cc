@@ -25,6 +25,7 @@
 #include "mirror/object_array-inl.h"
 #include "quick/quick_method_frame_info.h"
 #include "runtime.h"
+#include "stack_map.h"
 #include "thread.h"
 #include "thread_list.h"
 #include "throw_location.h"
@@ -156,6 +157,9 @@ bool StackVisitor::GetVReg(mirror::ArtMethod* m, uint16_t vreg, VRegKind kind,
   if (cur_quick_frame_ != nullptr) {
     DCHECK(context_ != nullptr);  // You can't reliably read registers without a context.
     DCHECK(m == GetMethod());
+    if (m->IsOptimized(sizeof(void*))) {
+      return GetVRegFromOptimizedCode(m, vreg, val);
+    }
     const void* code_pointer = m->GetQuickOatCodePointer(sizeof(void*));
     DCHECK(code_pointer != nullptr);
     const VmapTable vmap_table(m->GetVmapTable(code_pointer, sizeof(void*)));
@@ -210,6 +214,15 @@ bool StackVisitor::GetVRegPair(mirror::ArtMethod* m, uint16_t vreg, VRegKind kin
   if (cur_quick_frame_ != nullptr) {
     DCHECK(context_ != nullptr);  // You can't reliably read registers without a context.
     DCHECK(m == GetMethod());
+    if (m->IsOptimized(sizeof(void*))) {
+      uint32_t val_lo, val_hi;
+      if (!GetVRegFromOptimizedCode(m, vreg, &val_lo) ||
+          !GetVRegFromOptimizedCode(m, vreg + 1, &val_hi)) {
+        return false;
+      }
+      *val = (static_cast<uint64_t>(val_hi) << 32) | val_lo;
+      return true;
+    }
     const void* code_pointer = m->GetQuickOatCodePointer(sizeof(void*));
     DCHECK(code_pointer != nullptr);
     const VmapTable vmap_table(m->GetVmapTable(code_pointer, sizeof(void*)));
@@ -257,6 +270,9 @@ bool StackVisitor::SetVReg(mirror::ArtMethod* m, uint16_t vreg, uint32_t new_val
   if (cur_quick_frame_ != nullptr) {
     DCHECK(context_ != nullptr);  // You can't reliably write registers without a context.
     DCHECK(m == GetMethod());
+    if (m->IsOptimized(sizeof(void*))) {
+      return SetVRegFromOptimizedCode(m, vreg, new_value);
+    }
     const void* code_pointer = m->GetQuickOatCodePointer(sizeof(void*));
     DCHECK(code_pointer != nullptr);
     const VmapTable vmap_table(m->GetVmapTable(code_pointer, sizeof(void*)));
@@ -321,6 +337,10 @@ bool StackVisitor::SetVRegPair(mirror::ArtMethod* m, uint16_t vreg, uint64_t new
   if (cur_quick_frame_ != nullptr) {
     DCHECK(context_ != nullptr);  // You can't reliably write registers without a context.
     DCHECK(m == GetMethod());
+    if (m->IsOptimized(sizeof(void*))) {
+      return SetVRegFromOptimizedCode(m, vreg, static_cast<uint32_t>(new_value)) &&
+          SetVRegFromOptimizedCode(m, vreg + 1, static_cast<uint32_t>(new_value >> 32));
+    }
     const void* code_pointer = m->GetQuickOatCodePointer(sizeof(void*));
     DCHECK(code_pointer != nullptr);
     const VmapTable vmap_table(m->GetVmapTable(code_pointer, sizeof(void*)));
@@ -371,6 +391,61 @@ bool StackVisitor::SetVRegPair(mirror::ArtMethod* m, uint16_t vreg, uint64_t new
   }
 }
 
+bool StackVisitor::GetVRegFromOptimizedCode(mirror::ArtMethod* m, uint16_t vreg,
+                                            uint32_t* val) const {
+  const DexFile::CodeItem* code_item = m->GetCodeItem();
+  DCHECK(code_item != nullptr) << PrettyMethod(m);
+  DCHECK_LT(vreg, code_item->registers_size_);
+  CodeInfo<uint32_t> code_info = m->GetOptimizedCodeInfo();
+  StackMap<uint32_t> stack_map = code_info.GetStackMapForNativePc(GetNativePcOffset());
+  DexRegisterMap dex_register_map =
+      code_info.GetDexRegisterMapOf(stack_map, code_item->registers_size_);
+  int32_t value = dex_register_map.GetValue(vreg);
+  switch (dex_register_map.GetLocationKind(vreg)) {
+    case DexRegisterMap::kInStack:
+      *val = *reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(cur_quick_frame_) + value);
+      return true;
+    case DexRegisterMap::kInRegister: {
+      uintptr_t ptr_val;
+      if (!GetGPR(value, &ptr_val)) {
+        return false;
+      }
+      *val = static_cast<uint32_t>(ptr_val);
+      return true;
+    }
+    case DexRegisterMap::kConstant:
+      *val = value;
+      return true;
+  }
+  LOG(FATAL) << "Unexpected location kind " << dex_register_map.GetLocationKind(vreg);
+  return false;
+}
+
+bool StackVisitor::SetVRegFromOptimizedCode(mirror::ArtMethod* m, uint16_t vreg,
+                                            uint32_t new_value) {
+  const DexFile::CodeItem* code_item = m->GetCodeItem();
+  DCHECK(code_item != nullptr) << PrettyMethod(m);
+  DCHECK_LT(vreg, code_item->registers_size_);
+  CodeInfo<uint32_t> code_info = m->GetOptimizedCodeInfo();
+  StackMap<uint32_t> stack_map = code_info.GetStackMapForNativePc(GetNativePcOffset());
+  DexRegisterMap dex_register_map =
+      code_info.GetDexRegisterMapOf(stack_map, code_item->registers_size_);
+  int32_t value = dex_register_map.GetValue(vreg);
+  switch (dex_register_map.GetLocationKind(vreg)) {
+    case DexRegisterMap::kInStack:
+      *reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(cur_quick_frame_) + value) =
+          new_value;
+      return true;
+    case DexRegisterMap::kInRegister:
+      return SetGPR(value, new_value);
+    case DexRegisterMap::kConstant:
+      // The compiled code never reads a constant back from the frame, so it cannot be changed.
+      return false;
+  }
+  LOG(FATAL) << "Unexpected location kind " << dex_register_map.GetLocationKind(vreg);
+  return false;
+}
+
 uintptr_t* StackVisitor::GetGPRAddress(uint32_t reg) const {
   DCHECK(cur_quick_frame_ != NULL) << "This is a quick frame routine";
   return context_->GetGPRAddress(reg);
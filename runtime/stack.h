@@ -742,6 +742,12 @@ class StackVisitor {
   bool GetFPR(uint32_t reg, uintptr_t* val) const;
   bool SetFPR(uint32_t reg, uintptr_t value);
 
+  // Access a vreg of an optimized frame through the dex register map of its stack map.
+  bool GetVRegFromOptimizedCode(mirror::ArtMethod* m, uint16_t vreg, uint32_t* val) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  bool SetVRegFromOptimizedCode(mirror::ArtMethod* m, uint16_t vreg, uint32_t new_value)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   void SanityCheckFrame() const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   Thread* const thread_;
@@ -219,13 +219,23 @@ class StackMap {
 /**
  * Wrapper around all compiler information collected for a method.
  * The information is of the form:
- * [number_of_stack_maps, stack_mask_size, StackMap+, DexRegisterInfo+, InlineInfo*].
+ * [overall_size, number_of_stack_maps, stack_mask_size, StackMap+, DexRegisterInfo+,
+ *  InlineInfo*].
+ *
+ * Stack maps are sorted by native pc.
  */
 template <typename T>
 class CodeInfo {
  public:
   explicit CodeInfo(MemoryRegion region) : region_(region) {}
 
+  // Wraps encoded information whose size is only known from its header, e.g. the
+  // information the optimizing compiler stores in place of the vmap table.
+  explicit CodeInfo(const void* data) {
+    uint32_t size = reinterpret_cast<const uint32_t*>(data)[kOverallSizeOffset / sizeof(uint32_t)];
+    region_ = MemoryRegion(const_cast<void*>(data), size);
+  }
+
   StackMap<T> GetStackMapAt(size_t i) const {
     size_t size = StackMapSize();
     return StackMap<T>(GetStackMaps().Subregion(i * size, size));
@@ -247,6 +257,14 @@ class CodeInfo {
     region_.Store<uint32_t>(kNumberOfStackMapsOffset, number_of_stack_maps);
   }
 
+  uint32_t GetOverallSize() const {
+    return region_.Load<uint32_t>(kOverallSizeOffset);
+  }
+
+  void SetOverallSize(uint32_t size) {
+    region_.Store<uint32_t>(kOverallSizeOffset, size);
+  }
+
   size_t StackMapSize() const {
     return StackMap<T>::kFixedSize + GetStackMaskSize();
   }
@@ -265,30 +283,56 @@ class CodeInfo {
   }
 
   StackMap<T> GetStackMapForDexPc(uint32_t dex_pc) {
-    for (size_t i = 0, e = GetNumberOfStackMaps(); i < e; ++i) {
-      StackMap<T> stack_map = GetStackMapAt(i);
-      if (stack_map.GetDexPc() == dex_pc) {
-        return stack_map;
-      }
+    size_t index = FindStackMapIndexForDexPc(dex_pc);
+    if (index != kNoStackMap) {
+      return GetStackMapAt(index);
     }
     LOG(FATAL) << "Unreachable";
     return StackMap<T>(MemoryRegion());
   }
 
   StackMap<T> GetStackMapForNativePc(T native_pc) {
-    // TODO: stack maps are sorted by native pc, we can do a binary search.
-    for (size_t i = 0, e = GetNumberOfStackMaps(); i < e; ++i) {
-      StackMap<T> stack_map = GetStackMapAt(i);
-      if (stack_map.GetNativePc() == native_pc) {
-        return stack_map;
-      }
+    size_t index = FindStackMapIndexForNativePc(native_pc);
+    if (index != kNoStackMap) {
+      return GetStackMapAt(index);
     }
     LOG(FATAL) << "Unreachable";
     return StackMap<T>(MemoryRegion());
   }
 
+  // Returns the index of the first stack map for `dex_pc`, or kNoStackMap.
+  size_t FindStackMapIndexForDexPc(uint32_t dex_pc) const {
+    for (size_t i = 0, e = GetNumberOfStackMaps(); i < e; ++i) {
+      if (GetStackMapAt(i).GetDexPc() == dex_pc) {
+        return i;
+      }
+    }
+    return kNoStackMap;
+  }
+
+  // Returns the index of the stack map for `native_pc`, or kNoStackMap.
+  size_t FindStackMapIndexForNativePc(T native_pc) const {
+    size_t lo = 0;
+    size_t hi = GetNumberOfStackMaps();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      T mid_pc = GetStackMapAt(mid).GetNativePc();
+      if (mid_pc < native_pc) {
+        lo = mid + 1;
+      } else if (mid_pc > native_pc) {
+        hi = mid;
+      } else {
+        return mid;
+      }
+    }
+    return kNoStackMap;
+  }
+
+  static constexpr size_t kNoStackMap = static_cast<size_t>(-1);
+
  private:
-  static constexpr int kNumberOfStackMapsOffset = 0;
+  static constexpr int kOverallSizeOffset = 0;
+  static constexpr int kNumberOfStackMapsOffset = kOverallSizeOffset + sizeof(uint32_t);
   static constexpr int kStackMaskSizeOffset = kNumberOfStackMapsOffset + sizeof(uint32_t);
   static constexpr int kFixedSize = kStackMaskSizeOffset + sizeof(uint32_t);
 
@@ -302,6 +346,9 @@ class CodeInfo {
   template<typename U> friend class StackMapStream;
 };
 
+template <typename T>
+constexpr size_t CodeInfo<T>::kNoStackMap;
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_STACK_MAP_H_
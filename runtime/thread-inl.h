@@ -149,6 +149,13 @@ inline ThreadState Thread::TransitionFromSuspendedToRunnable() {
       // Failed to transition to Runnable. Release shared mutator_lock_ access and try again.
       Locks::mutator_lock_->SharedUnlock(this);
     } else {
+      // Run the flip function, if it was left for us by ThreadList::FlipThreadRoots.
+      if (UNLIKELY(tlsPtr_.flip_function != nullptr)) {
+        Closure* flip_function = GetFlipFunction();
+        if (flip_function != nullptr) {
+          flip_function->Run(this);
+        }
+      }
       return static_cast<ThreadState>(old_state);
     }
   } while (true);
@@ -46,6 +46,7 @@
 #include "handle_scope-inl.h"
 #include "handle_scope.h"
 #include "indirect_reference_table-inl.h"
+#include "interpreter/interpreter_cache.h"
 #include "jni_internal.h"
 #include "mirror/art_field-inl.h"
 #include "mirror/art_method-inl.h"
@@ -697,6 +698,32 @@ void Thread::RunCheckpointFunction() {
   CHECK(found_checkpoint);
 }
 
+void Thread::SetFlipFunction(Closure* function) {
+  CHECK(function != nullptr);
+  Atomic<Closure*>* atomic_function = reinterpret_cast<Atomic<Closure*>*>(&tlsPtr_.flip_function);
+  atomic_function->StoreSequentiallyConsistent(function);
+}
+
+Closure* Thread::GetFlipFunction() {
+  Atomic<Closure*>* atomic_function = reinterpret_cast<Atomic<Closure*>*>(&tlsPtr_.flip_function);
+  Closure* function;
+  do {
+    function = atomic_function->LoadRelaxed();
+    if (function == nullptr) {
+      return nullptr;
+    }
+  } while (!atomic_function->CompareExchangeWeakSequentiallyConsistent(function, nullptr));
+  return function;
+}
+
+InterpreterCache* Thread::GetInterpreterCache() {
+  DCHECK_EQ(this, Thread::Current());
+  if (UNLIKELY(tlsPtr_.interpreter_cache == nullptr)) {
+    tlsPtr_.interpreter_cache = new InterpreterCache;
+  }
+  return tlsPtr_.interpreter_cache;
+}
+
 bool Thread::RequestCheckpoint(Closure* function) {
   union StateAndFlags old_state_and_flags;
   old_state_and_flags.as_int = tls32_.state_and_flags.as_int;
@@ -741,9 +768,11 @@ void Thread::FullSuspendCheck() {
   VLOG(threads) << this << " self-suspending";
   ATRACE_BEGIN("Full suspend check");
   // Make thread appear suspended to other threads, release mutator_lock_.
+  tls32_.suspended_at_suspend_check = true;
   TransitionFromRunnableToSuspended(kSuspended);
   // Transition back to runnable noting requests to suspend, re-acquire share on mutator_lock_.
   TransitionFromSuspendedToRunnable();
+  tls32_.suspended_at_suspend_check = false;
   ATRACE_END();
   VLOG(threads) << this << " self-reviving";
 }
@@ -1243,6 +1272,7 @@ Thread::~Thread() {
   delete tlsPtr_.instrumentation_stack;
   delete tlsPtr_.name;
   delete tlsPtr_.stack_trace_sample;
+  delete tlsPtr_.interpreter_cache;
   free(tlsPtr_.nested_signal_state);
 
   Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(this);
@@ -1407,6 +1437,12 @@ void Thread::NotifyLocked(Thread* self) {
   }
 }
 
+// Entries of an internal stack trace's pc array for compiled frames hold the native pc offset
+// with this bit set. Mapping them to dex pcs is left to the decoding of the trace, as most
+// traces of caught exceptions are never looked at. Offsets stay valid because the code of a
+// method does not change once it has run: instrumentation falls back to the oat code.
+static constexpr uint32_t kInternalStackTraceNativePcFlag = 0x80000000u;
+
 class CountStackDepthVisitor : public StackVisitor {
  public:
   explicit CountStackDepthVisitor(Thread* thread)
@@ -1500,8 +1536,17 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
       return true;  // Ignore runtime frames (in particular callee save).
     }
     method_trace_->Set<kTransactionActive>(count_, m);
-    dex_pc_trace_->Set<kTransactionActive>(count_,
-        m->IsProxyMethod() ? DexFile::kDexNoIndex : GetDexPc());
+    uint32_t pc;
+    if (m->IsProxyMethod() || m->IsNative()) {
+      pc = DexFile::kDexNoIndex;
+    } else if (!IsShadowFrame() && !m->IsPortableCompiled()) {
+      uintptr_t native_pc_offset = GetNativePcOffset();
+      DCHECK_LT(native_pc_offset, kInternalStackTraceNativePcFlag);
+      pc = native_pc_offset | kInternalStackTraceNativePcFlag;
+    } else {
+      pc = GetDexPc();
+    }
+    dex_pc_trace_->Set<kTransactionActive>(count_, pc);
     ++count_;
     return true;
   }
@@ -1551,6 +1596,15 @@ template jobject Thread::CreateInternalStackTrace<false>(
 template jobject Thread::CreateInternalStackTrace<true>(
     const ScopedObjectAccessAlreadyRunnable& soa) const;
 
+uint32_t Thread::InternalStackTraceDexPc(mirror::ArtMethod* method, uint32_t pc) {
+  if (pc == DexFile::kDexNoIndex || (pc & kInternalStackTraceNativePcFlag) == 0) {
+    return pc;
+  }
+  uintptr_t code = reinterpret_cast<uintptr_t>(
+      Runtime::Current()->GetInstrumentation()->GetQuickCodeFor(method, sizeof(void*)));
+  return method->ToDexPc(code + (pc & ~kInternalStackTraceNativePcFlag), false);
+}
+
 jobjectArray Thread::InternalStackTraceToStackTraceElementArray(
     const ScopedObjectAccessAlreadyRunnable& soa, jobject internal, jobjectArray output_array,
     int* stack_depth) {
@@ -1597,7 +1651,7 @@ jobjectArray Thread::InternalStackTraceToStackTraceElementArray(
       // source_name_object intentionally left null for proxy methods
     } else {
       mirror::IntArray* pc_trace = down_cast<mirror::IntArray*>(method_trace->Get(depth));
-      uint32_t dex_pc = pc_trace->Get(i);
+      uint32_t dex_pc = InternalStackTraceDexPc(method, pc_trace->Get(i));
       line_number = method->GetLineNumFromDexPC(dex_pc);
       // Allocate element, potentially triggering GC
       // TODO: reuse class_name_object via Class::name_?
@@ -2096,6 +2150,43 @@ class ReferenceMapVisitor : public StackVisitor {
   }
 
  private:
+  // Optimized frames record references by stack slot and by register rather than by vreg, so
+  // the visitor is not told which vreg a reference belongs to.
+  void VisitOptimizedFrame(mirror::ArtMethod* m, StackReference<mirror::ArtMethod>* cur_quick_frame)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    Runtime* runtime = Runtime::Current();
+    const void* entry_point = runtime->GetInstrumentation()->GetQuickCodeFor(m, sizeof(void*));
+    uintptr_t native_pc_offset = m->NativePcOffset(GetCurrentQuickFramePc(), entry_point);
+    CodeInfo<uint32_t> code_info = m->GetOptimizedCodeInfo();
+    StackMap<uint32_t> map = code_info.GetStackMapForNativePc(native_pc_offset);
+    // Visit stack entries that hold references.
+    MemoryRegion stack_mask = map.GetStackMask();
+    for (size_t i = 0; i < stack_mask.size_in_bits(); ++i) {
+      if (stack_mask.LoadBit(i)) {
+        StackReference<mirror::Object>* ref_addr =
+            reinterpret_cast<StackReference<mirror::Object>*>(cur_quick_frame) + i;
+        mirror::Object* ref = ref_addr->AsMirrorPtr();
+        if (ref != nullptr) {
+          mirror::Object* new_ref = ref;
+          visitor_(&new_ref, -1, this);
+          if (ref != new_ref) {
+            ref_addr->Assign(new_ref);
+          }
+        }
+      }
+    }
+    // Visit callee-save registers that hold references.
+    uint32_t register_mask = map.GetRegisterMask();
+    for (size_t i = 0; i < BitSizeOf<uint32_t>(); ++i) {
+      if ((register_mask & (1u << i)) != 0) {
+        mirror::Object** ref_addr = reinterpret_cast<mirror::Object**>(GetGPRAddress(i));
+        if (*ref_addr != nullptr) {
+          visitor_(ref_addr, -1, this);
+        }
+      }
+    }
+  }
+
   void VisitQuickFrame() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     StackReference<mirror::ArtMethod>* cur_quick_frame = GetCurrentQuickFrame();
     mirror::ArtMethod* m = cur_quick_frame->AsMirrorPtr();
@@ -2107,6 +2198,10 @@ class ReferenceMapVisitor : public StackVisitor {
 
     // Process register map (which native and runtime methods don't have)
     if (!m->IsNative() && !m->IsRuntimeMethod() && !m->IsProxyMethod()) {
+      if (m->IsOptimized(sizeof(void*))) {
+        VisitOptimizedFrame(m, cur_quick_frame);
+        return;
+      }
       const uint8_t* native_gc_map = m->GetNativeGcMap(sizeof(void*));
       CHECK(native_gc_map != nullptr) << PrettyMethod(m);
       const DexFile::CodeItem* code_item = m->GetCodeItem();
@@ -2243,6 +2338,9 @@ void Thread::VisitRoots(RootCallback* visitor, void* arg) {
     visitor(reinterpret_cast<mirror::Object**>(&frame.method_), arg,
             RootInfo(kRootVMInternal, thread_id));
   }
+  if (tlsPtr_.interpreter_cache != nullptr) {
+    tlsPtr_.interpreter_cache->VisitRoots(visitor, arg, RootInfo(kRootVMInternal, thread_id));
+  }
 }
 
 static void VerifyRoot(mirror::Object** root, void* /*arg*/, const RootInfo& /*root_info*/)
@@ -67,6 +67,7 @@ class BaseMutex;
 class ClassLinker;
 class Closure;
 class Context;
+class InterpreterCache;
 struct DebugInvokeReq;
 class DexFile;
 class JavaVMExt;
@@ -470,6 +471,11 @@ class Thread {
   jobject CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) const
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Returns the dex pc for an entry of the pc array of an internal stack trace. Compiled frames
+  // are recorded by native pc and only mapped to a dex pc here.
+  static uint32_t InternalStackTraceDexPc(mirror::ArtMethod* method, uint32_t pc)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Convert an internal stack trace representation (returned by CreateInternalStackTrace) to a
   // StackTraceElement[]. If output_array is NULL, a new array is created, otherwise as many
   // frames as will fit are written into the given array. If stack_depth is non-NULL, it's updated
@@ -762,6 +768,17 @@ class Thread {
 
   void RunCheckpointFunction();
 
+  bool IsSuspendedAtSuspendCheck() const {
+    return tls32_.suspended_at_suspend_check;
+  }
+
+  void SetFlipFunction(Closure* function);
+  // Takes the pending flip function, if any, so that it is run exactly once.
+  Closure* GetFlipFunction();
+
+  // The interpreter's side table for this thread, created on first use.
+  InterpreterCache* GetInterpreterCache();
+
   bool ReadFlag(ThreadFlag flag) const {
     return (tls32_.state_and_flags.as_struct.flags & flag) != 0;
   }
@@ -827,6 +844,16 @@ class Thread {
     tlsPtr_.rosalloc_runs[index] = run;
   }
 
+  // Bytes left to allocate before the next allocation sample, see gc::AllocationSampler. 0 until
+  // the thread first allocates with sampling enabled.
+  size_t GetAllocSampleBytesLeft() const {
+    return tlsPtr_.alloc_sample_bytes_left;
+  }
+
+  void SetAllocSampleBytesLeft(size_t bytes) {
+    tlsPtr_.alloc_sample_bytes_left = bytes;
+  }
+
   bool IsExceptionReportedToInstrumentation() const {
     return tls32_.is_exception_reported_to_instrumentation_;
   }
@@ -958,7 +985,7 @@ class Thread {
       suspend_count(0), debug_suspend_count(0), thin_lock_thread_id(0), tid(0),
       daemon(is_daemon), throwing_OutOfMemoryError(false), no_thread_suspension(0),
       thread_exit_check_count(0), is_exception_reported_to_instrumentation_(false),
-      handling_signal_(false), padding_(0) {
+      handling_signal_(false), suspended_at_suspend_check(false) {
     }
 
     union StateAndFlags state_and_flags;
@@ -1002,8 +1029,9 @@ class Thread {
     // True if signal is being handled by this thread.
     bool32_t handling_signal_;
 
-    // Padding to make the size aligned to 8.  Remove this if we add another 32 bit field.
-    int32_t padding_;
+    // True if the thread is suspended in FullSuspendCheck. Such a thread was runnable, and runs its
+    // own flip function when it is resumed.
+    bool32_t suspended_at_suspend_check;
   } tls32_;
 
   struct PACKED(8) tls_64bit_sized_values {
@@ -1029,7 +1057,9 @@ class Thread {
       deoptimization_shadow_frame(nullptr), shadow_frame_under_construction(nullptr), name(nullptr),
       pthread_self(0), last_no_thread_suspension_cause(nullptr), thread_local_start(nullptr),
       thread_local_pos(nullptr), thread_local_end(nullptr), thread_local_objects(0),
-      thread_local_alloc_stack_top(nullptr), thread_local_alloc_stack_end(nullptr) {
+      thread_local_alloc_stack_top(nullptr), thread_local_alloc_stack_end(nullptr),
+      nested_signal_state(nullptr), flip_function(nullptr),
+      interpreter_cache(nullptr), alloc_sample_bytes_left(0) {
     }
 
     // The biased card table, see CardTable for details.
@@ -1144,6 +1174,16 @@ class Thread {
 
     // Recorded thread state for nested signals.
     jmp_buf* nested_signal_state;
+
+    // Closure left by ThreadList::FlipThreadRoots to run before the thread next runs managed
+    // code, or NULL. Whoever takes it with GetFlipFunction runs it.
+    Closure* flip_function;
+
+    // Resolved fields and inline caches of the interpreter, or NULL before first use.
+    InterpreterCache* interpreter_cache;
+
+    // Budget of the allocation sampler.
+    size_t alloc_sample_bytes_left;
   } tlsPtr_;
 
   // Guards the 'interrupted_' and 'wait_monitor_' members.
@@ -363,6 +363,87 @@ void ThreadList::SuspendAll() {
   }
 }
 
+size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor, Closure* flip_callback) {
+  Thread* self = Thread::Current();
+  ATRACE_BEGIN("Flipping mutator threads");
+  uint64_t start_time = NanoTime();
+
+  Locks::mutator_lock_->AssertNotHeld(self);
+  Locks::thread_list_lock_->AssertNotHeld(self);
+  Locks::thread_suspend_count_lock_->AssertNotHeld(self);
+  CHECK_NE(self->GetState(), kRunnable);
+  {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+    // Update global suspend all state for attaching threads.
+    ++suspend_all_count_;
+    for (const auto& thread : list_) {
+      if (thread != self) {
+        thread->ModifySuspendCount(self, +1, false);
+      }
+    }
+  }
+
+  // Block on the mutator lock until all Runnable threads release their share of access, and run
+  // the flip callback while every thread is stopped.
+  Locks::mutator_lock_->ExclusiveLock(self);
+  flip_callback->Run(self);
+  Locks::mutator_lock_->ExclusiveUnlock(self);
+
+  uint64_t end_time = NanoTime();
+  if (end_time - start_time > kLongThreadSuspendThreshold) {
+    LOG(WARNING) << "Flipping all threads took: " << PrettyDuration(end_time - start_time);
+  }
+
+  // Resume the threads that were runnable right away, they run the flip function themselves.
+  std::vector<Thread*> other_threads;
+  size_t runnable_thread_count = 0;
+  {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+    --suspend_all_count_;
+    for (const auto& thread : list_) {
+      if (thread == self) {
+        continue;
+      }
+      // Set the flip function for suspended threads as well, the thread may get to run it
+      // before we do below.
+      thread->SetFlipFunction(thread_flip_visitor);
+      if (thread->IsSuspendedAtSuspendCheck()) {
+        thread->ModifySuspendCount(self, -1, false);
+        ++runnable_thread_count;
+      } else {
+        other_threads.push_back(thread);
+      }
+    }
+    Thread::resume_cond_->Broadcast(self);
+  }
+
+  // Run the flip function on behalf of the other threads, which can not exit or become runnable
+  // while they are still suspended.
+  {
+    ReaderMutexLock mu(self, *Locks::mutator_lock_);
+    for (Thread* thread : other_threads) {
+      Closure* flip_function = thread->GetFlipFunction();
+      if (flip_function != nullptr) {
+        flip_function->Run(thread);
+      }
+    }
+    thread_flip_visitor->Run(self);
+  }
+
+  // Resume the other threads.
+  {
+    MutexLock mu(self, *Locks::thread_suspend_count_lock_);
+    for (Thread* thread : other_threads) {
+      thread->ModifySuspendCount(self, -1, false);
+    }
+    Thread::resume_cond_->Broadcast(self);
+  }
+  ATRACE_END();
+  return runnable_thread_count + other_threads.size() + 1;  // +1 for self.
+}
+
 void ThreadList::ResumeAll() {
   Thread* self = Thread::Current();
 
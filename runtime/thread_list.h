@@ -96,6 +96,16 @@ class ThreadList {
   size_t RunCheckpointOnRunnableThreads(Closure* checkpoint_function)
       LOCKS_EXCLUDED(Locks::thread_list_lock_, Locks::thread_suspend_count_lock_);
 
+  // Suspends all threads just long enough to run flip_callback with exclusive access to the
+  // mutator_lock_, then lets threads resume one at a time: each runs thread_flip_visitor before it
+  // next runs managed code. Threads that were runnable run it themselves as they come out of their
+  // suspend check, the others have it run on their behalf before they are resumed. Returns the
+  // number of threads, including self, that thread_flip_visitor is run for.
+  size_t FlipThreadRoots(Closure* thread_flip_visitor, Closure* flip_callback)
+      LOCKS_EXCLUDED(Locks::mutator_lock_,
+                     Locks::thread_list_lock_,
+                     Locks::thread_suspend_count_lock_);
+
   // Suspends all threads
   void SuspendAllForDebugger()
       LOCKS_EXCLUDED(Locks::mutator_lock_,
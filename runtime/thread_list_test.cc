@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "thread_list.h"
+
+#include "atomic.h"
+#include "common_runtime_test.h"
+#include "entrypoints/entrypoint_utils-inl.h"
+#include "scoped_thread_state_change.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
+
+namespace art {
+
+// Keeps its thread runnable, passing suspend checks, until it is told to stop.
+class SpinTask : public Task {
+ public:
+  SpinTask(AtomicInteger* started, Atomic<bool>* stop) : started_(started), stop_(stop) {}
+
+  void Run(Thread* self) {
+    ScopedObjectAccess soa(self);
+    ++*started_;
+    while (!stop_->LoadSequentiallyConsistent()) {
+      CheckSuspend(self);
+    }
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+ private:
+  AtomicInteger* const started_;
+  Atomic<bool>* const stop_;
+};
+
+class CountFlipClosure : public Closure {
+ public:
+  CountFlipClosure() : count_(0) {}
+
+  void Run(Thread* thread) OVERRIDE {
+    Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
+    CHECK(thread != nullptr);
+    ++count_;
+  }
+
+  int32_t Count() {
+    return count_.LoadSequentiallyConsistent();
+  }
+
+ private:
+  AtomicInteger count_;
+};
+
+class CheckPausedClosure : public Closure {
+ public:
+  CheckPausedClosure() : runs_(0) {}
+
+  void Run(Thread* self) OVERRIDE {
+    Locks::mutator_lock_->AssertExclusiveHeld(self);
+    ++runs_;
+  }
+
+  size_t runs_;
+};
+
+class ThreadListTest : public CommonRuntimeTest {};
+
+TEST_F(ThreadListTest, FlipThreadRoots) {
+  Thread* self = Thread::Current();
+  static constexpr size_t kNumWorkers = 4;
+  static constexpr int32_t kNumSpinners = 2;
+  ThreadPool thread_pool("Thread list test thread pool", kNumWorkers);
+  AtomicInteger started(0);
+  Atomic<bool> stop(false);
+  for (int32_t i = 0; i < kNumSpinners; ++i) {
+    thread_pool.AddTask(self, new SpinTask(&started, &stop));
+  }
+  thread_pool.StartWorkers(self);
+  while (started.LoadSequentiallyConsistent() != kNumSpinners) {
+    usleep(1000);
+  }
+
+  // Two workers are runnable and run their flip function themselves, the idle ones and self have
+  // it run for them.
+  CountFlipClosure flip_visitor;
+  CheckPausedClosure flip_callback;
+  size_t flipped = Runtime::Current()->GetThreadList()->FlipThreadRoots(&flip_visitor,
+                                                                         &flip_callback);
+  EXPECT_EQ(1U, flip_callback.runs_);
+  EXPECT_LE(kNumWorkers + 1, flipped);
+  for (size_t i = 0; i < 1000 && static_cast<size_t>(flip_visitor.Count()) != flipped; ++i) {
+    usleep(1000);
+  }
+  EXPECT_EQ(flipped, static_cast<size_t>(flip_visitor.Count()));
+
+  stop.StoreSequentiallyConsistent(true);
+  thread_pool.Wait(self, false, false);
+}
+
+}  // namespace art
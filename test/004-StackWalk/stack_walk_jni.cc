@@ -16,6 +16,7 @@
 
 #include <stdio.h>
 #include <memory>
+#include <vector>
 
 #include "class_linker.h"
 #include "gc_map.h"
@@ -25,6 +26,7 @@
 #include "mirror/object-inl.h"
 #include "jni.h"
 #include "scoped_thread_state_change.h"
+#include "stack_map.h"
 
 namespace art {
 
@@ -58,7 +60,25 @@ struct TestReferenceMapVisitor : public StackVisitor {
       return true;
     }
     const uint8_t* reg_bitmap = NULL;
-    if (!IsShadowFrame()) {
+    std::vector<uint8_t> optimized_reg_bitmap;
+    if (!IsShadowFrame() && m->IsOptimized(sizeof(void*))) {
+      // Rebuild a dex register bitmap from the stack mask and the dex register map.
+      CodeInfo<uint32_t> code_info = m->GetOptimizedCodeInfo();
+      StackMap<uint32_t> stack_map = code_info.GetStackMapForNativePc(GetNativePcOffset());
+      uint16_t num_regs = m->GetCodeItem()->registers_size_;
+      DexRegisterMap dex_registers = code_info.GetDexRegisterMapOf(stack_map, num_regs);
+      MemoryRegion stack_mask = stack_map.GetStackMask();
+      optimized_reg_bitmap.resize(RoundUp(num_regs, kBitsPerByte) / kBitsPerByte);
+      for (uint16_t reg = 0; reg < num_regs; ++reg) {
+        if (dex_registers.GetLocationKind(reg) == DexRegisterMap::kInStack) {
+          size_t slot = dex_registers.GetValue(reg) / sizeof(StackReference<mirror::Object>);
+          if (slot < stack_mask.size_in_bits() && stack_mask.LoadBit(slot)) {
+            optimized_reg_bitmap[reg / kBitsPerByte] |= 1 << (reg % kBitsPerByte);
+          }
+        }
+      }
+      reg_bitmap = optimized_reg_bitmap.data();
+    } else if (!IsShadowFrame()) {
       NativePcOffsetToReferenceMap map(m->GetNativeGcMap(sizeof(void*)));
       reg_bitmap = map.FindBitMap(GetNativePcOffset());
     }
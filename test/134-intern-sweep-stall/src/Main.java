@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measures how long String.intern() stalls while concurrent GCs sweep an intern table of
+ * increasing size.
+ */
+public class Main {
+    private static final int[] TABLE_SIZES = { 1000, 10000, 100000 };
+    private static final int GC_COUNT = 5;
+
+    static class GcThread extends Thread {
+        volatile boolean done;
+
+        public void run() {
+            for (int i = 0; i < GC_COUNT; ++i) {
+                System.gc();
+            }
+            done = true;
+        }
+    }
+
+    static public void main(String[] args) throws Exception {
+        boolean timing = (args.length >= 1) && args[0].equals("--timing");
+        run(timing);
+    }
+
+    // Returns the longest time in nanoseconds a single intern call took.
+    static long measure(int tableSize) throws Exception {
+        // Keep the interned strings alive so that every GC sweeps the whole table.
+        String[] interned = new String[tableSize];
+        for (int i = 0; i < tableSize; ++i) {
+            interned[i] = ("table-" + i).intern();
+        }
+
+        GcThread gcThread = new GcThread();
+        gcThread.start();
+        long maxStall = 0;
+        int i = 0;
+        while (!gcThread.done) {
+            String s = "new-" + tableSize + "-" + i;
+            long start = System.nanoTime();
+            String t = s.intern();
+            long stall = System.nanoTime() - start;
+            if (t != s) {
+                System.out.println("Interned a fresh string to a different object: " + s);
+            }
+            maxStall = Math.max(maxStall, stall);
+            ++i;
+        }
+        gcThread.join();
+
+        boolean identityPreserved = true;
+        for (int j = 0; j < tableSize; ++j) {
+            if (new String("table-" + j).intern() != interned[j]) {
+                identityPreserved = false;
+            }
+        }
+        System.out.println(tableSize + " interns: " +
+                           (identityPreserved ? "identity preserved" : "identity lost"));
+        return maxStall;
+    }
+
+    static public void run(boolean timing) throws Exception {
+        long[] maxStalls = new long[TABLE_SIZES.length];
+        for (int i = 0; i < TABLE_SIZES.length; ++i) {
+            maxStalls[i] = measure(TABLE_SIZES[i]);
+        }
+
+        // The stall should not grow with the size of the table. Allow for scheduling noise.
+        long smallest = Math.max(maxStalls[0], 1000000);
+        long largest = maxStalls[maxStalls.length - 1];
+        if (largest < smallest * 20) {
+            System.out.println("Timing is acceptable.");
+        } else {
+            System.out.println("Intern stalls grow with the table size!");
+            timing = true;
+        }
+        if (timing) {
+            for (int i = 0; i < TABLE_SIZES.length; ++i) {
+                System.out.printf("%d interns: longest stall %.3g msec\n", TABLE_SIZES[i],
+                                  maxStalls[i] / 1000000.0);
+            }
+        }
+    }
+}
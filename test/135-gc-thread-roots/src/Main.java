@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.concurrent.CountDownLatch;
+
+/**
+ * Measures how long a full GC takes with an increasing number of blocked threads, each of which
+ * holds references on a moderately deep stack.
+ */
+public class Main {
+    private static final int[] THREAD_COUNTS = { 0, 64, 256 };
+    private static final int STACK_DEPTH = 32;
+    private static final int GC_COUNT = 5;
+    private static final int CHURN_COUNT = 1 << 20;
+
+    // What each frame keeps alive. A root the GC missed is freed and its memory reused by the
+    // garbage allocated after the GCs, which changes its class or its contents.
+    static class Root {
+        final int depth;
+        final long value;
+
+        Root(int depth, long value) {
+            this.depth = depth;
+            this.value = value;
+        }
+
+        static long expectedValue(int id, int depth) {
+            return ((long) id << 32) ^ (depth * 0x9e3779b9L);
+        }
+
+        boolean isIntact(int id, int depth) {
+            return getClass() == Root.class && this.depth == depth &&
+                   value == expectedValue(id, depth);
+        }
+    }
+
+    static class RootThread extends Thread {
+        private final int id;
+        private final CountDownLatch started;
+        private final CountDownLatch release;
+        volatile boolean rootsAlive;
+
+        RootThread(int id, CountDownLatch started, CountDownLatch release) {
+            this.id = id;
+            this.started = started;
+            this.release = release;
+        }
+
+        public void run() {
+            rootsAlive = recurse(STACK_DEPTH);
+        }
+
+        // Keeps one object per frame alive until the thread is released, then checks that none
+        // of them was collected.
+        private boolean recurse(int depth) {
+            Root root = new Root(depth, Root.expectedValue(id, depth));
+            if (depth == 0) {
+                started.countDown();
+                try {
+                    release.await();
+                } catch (InterruptedException e) {
+                    return false;
+                }
+                return root.isIntact(id, depth);
+            }
+            boolean deeperAlive = recurse(depth - 1);
+            return root.isIntact(id, depth) && deeperAlive;
+        }
+    }
+
+    // Allocates garbage of about the size of a Root, filled with values no Root holds, so that
+    // the memory of roots collected by mistake gets reused.
+    static void churn() {
+        Object[] keep = new Object[1024];
+        for (int i = 0; i < CHURN_COUNT; ++i) {
+            long[] garbage = new long[2];
+            garbage[0] = -1L;
+            garbage[1] = -1L;
+            keep[i % keep.length] = garbage;
+        }
+    }
+
+    static public void main(String[] args) throws Exception {
+        boolean timing = (args.length >= 1) && args[0].equals("--timing");
+        run(timing);
+    }
+
+    // Returns the average time in nanoseconds of a System.gc() call.
+    static long measure(int threadCount) throws Exception {
+        CountDownLatch started = new CountDownLatch(threadCount);
+        CountDownLatch release = new CountDownLatch(1);
+        RootThread[] threads = new RootThread[threadCount];
+        for (int i = 0; i < threadCount; ++i) {
+            threads[i] = new RootThread(i, started, release);
+            threads[i].start();
+        }
+        started.await();
+
+        // Warm up before timing.
+        System.gc();
+        long start = System.nanoTime();
+        for (int i = 0; i < GC_COUNT; ++i) {
+            System.gc();
+        }
+        long average = (System.nanoTime() - start) / GC_COUNT;
+
+        churn();
+        System.gc();
+        churn();
+        release.countDown();
+        boolean rootsAlive = true;
+        for (RootThread thread : threads) {
+            thread.join();
+            rootsAlive &= thread.rootsAlive;
+        }
+        System.out.println(threadCount + " threads: " +
+                           (rootsAlive ? "roots kept alive" : "roots lost"));
+        return average;
+    }
+
+    static public void run(boolean timing) throws Exception {
+        long[] averages = new long[THREAD_COUNTS.length];
+        for (int i = 0; i < THREAD_COUNTS.length; ++i) {
+            averages[i] = measure(THREAD_COUNTS[i]);
+        }
+
+        // Marking thread roots is a small part of a GC; make sure it does not come to dominate
+        // it. Allow for scheduling noise.
+        long smallest = Math.max(averages[0], 1000000);
+        long largest = averages[averages.length - 1];
+        if (largest < smallest * 20) {
+            System.out.println("Timing is acceptable.");
+        } else {
+            System.out.println("GC time grows too fast with the thread count!");
+            timing = true;
+        }
+        if (timing) {
+            for (int i = 0; i < THREAD_COUNTS.length; ++i) {
+                System.out.printf("%d threads: %.3g msec per GC\n", THREAD_COUNTS[i],
+                                  averages[i] / 1000000.0);
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static class Base {
+    int value = 1;
+    int get() { return value; }
+  }
+
+  static class Derived1 extends Base {
+    int get() { return value + 10; }
+  }
+
+  static class Derived2 extends Derived1 {
+    int extra = 5;
+    int get() { return value + extra + 100; }
+  }
+
+  interface Shape {
+    int sides();
+  }
+
+  interface Named {
+    String name();
+  }
+
+  static class Triangle implements Named, Shape {
+    public String name() { return "triangle"; }
+    public int sides() { return 3; }
+  }
+
+  static class Square implements Shape, Named {
+    public int sides() { return 4; }
+    public String name() { return "square"; }
+  }
+
+  static class Pentagon extends Square {
+    public int sides() { return 5; }
+    public String name() { return "pentagon"; }
+  }
+
+  // A single call site that sees each receiver class in turn.
+  static int callGet(Base b) {
+    return b.get();
+  }
+
+  static int callSides(Shape s) {
+    return s.sides();
+  }
+
+  static String callName(Named n) {
+    return n.name();
+  }
+
+  static int readValue(Base b) {
+    return b.value;
+  }
+
+  public static void main(String[] args) {
+    Base[] bases = { new Base(), new Derived1(), new Derived2(), new Derived1(), new Base() };
+    int virtualSum = 0;
+    for (int i = 0; i < 1000; i++) {
+      for (Base b : bases) {
+        virtualSum += callGet(b);
+      }
+    }
+    System.out.println("virtual: " + virtualSum);
+
+    Object[] shapes = { new Triangle(), new Square(), new Pentagon(), new Triangle() };
+    int sides = 0;
+    StringBuilder names = new StringBuilder();
+    for (int i = 0; i < 1000; i++) {
+      for (Object o : shapes) {
+        sides += callSides((Shape) o);
+        if (i == 0) {
+          names.append(callName((Named) o)).append(' ');
+        }
+      }
+    }
+    System.out.println("interface: " + sides + " " + names.toString().trim());
+
+    int fieldSum = 0;
+    for (int i = 0; i < 1000; i++) {
+      for (Base b : bases) {
+        b.value = i;
+        fieldSum += readValue(b);
+      }
+    }
+    System.out.println("field: " + fieldSum);
+
+    try {
+      callGet(null);
+      System.out.println("no exception");
+    } catch (NullPointerException expected) {
+      System.out.println("null receiver: NullPointerException");
+    }
+  }
+}
@@ -54,7 +54,9 @@ endef  # all-run-test-target-names
 TEST_ART_TIMING_SENSITIVE_RUN_TESTS := \
   053-wait-some \
   055-enum-performance \
-  133-static-invoke-super
+  133-static-invoke-super \
+  134-intern-sweep-stall \
+  135-gc-thread-roots
 
  # disable timing sensitive tests on "dist" builds.
 ifdef dist_goal
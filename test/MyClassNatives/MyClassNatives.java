@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+import dalvik.annotation.optimization.CriticalNative;
+
 class MyClassNatives {
     native void throwException();
     native void foo();
@@ -98,4 +100,9 @@ class MyClassNatives {
     static native boolean returnTrue();
     static native boolean returnFalse();
     static native int returnInt();
+
+    @CriticalNative
+    static native long criticalIJIJ(int i1, long l1, int i2, long l2);
+    @CriticalNative
+    static native double criticalDFID(double d1, float f1, int i1, double d2);
 }